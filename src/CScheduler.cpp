@@ -0,0 +1,602 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <system_error>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CThread.h"
+#include "itv_mode.h"
+#include "Grid.h"
+#include "Output.h"
+#include "GridEnvir.h"
+#include "CSimulation.h"
+#include "CScheduler.h"
+#include "Checkpoint.h"
+
+static const char* ManifestHeader = "IBC-grass checkpoint manifest 1";
+
+static long fileSize(const std::string& aFilename)
+{
+    struct stat status;
+
+    if (stat(aFilename.c_str(), &status) != 0)
+    {
+        return -1;
+    }
+    return status.st_size;
+}
+
+CScheduler::CScheduler(int aMaxThreads) :
+    MaxThreads(aMaxThreads < 1 ? 1 : aMaxThreads),
+    RunningThreads(0), SubmittedJobs(0), WrittenJobs(0), Failed(false),
+    QueuedBytes(0), OpenJob(-1), WriteError(false),
+    Checkpoints(false), Line(-1), StartSeed(-1),
+    Closing(false),
+    Writer(&CScheduler::WriteLoop, this)
+{
+
+}
+
+CScheduler::~CScheduler()
+{
+    {
+        std::unique_lock<std::mutex> guard(Lock);
+
+        Changed.wait(guard, [this] { return RunningThreads == 0; });
+        joinEnded();
+
+        Closing = true;
+    }
+    Changed.notify_all();
+
+    if (Writer.joinable())
+    {
+        Writer.join();
+    }
+}
+
+//
+//  Without a manifest the batch starts from the beginning. The start seed of the batch is
+//  taken from the manifest; a different one on the command line is an error.
+void CScheduler::Resume(const std::string& aPrefix, const std::string& aSimFile, int aLine, int& aStartSeed)
+{
+    const std::string name = "data/out/" + aPrefix + "_checkpoint.txt";
+    std::ifstream manifest(name.c_str());
+
+    std::string line;
+    if (!getline(manifest, line) || line != ManifestHeader)
+    {
+        std::cerr << "No checkpoint manifest " << name << ", the batch starts from the beginning\n";
+        return;
+    }
+
+    std::string simfile;
+    int execline = -1, seed = -1, written = 0;
+
+    while (getline(manifest, line))
+    {
+        std::istringstream ss(line);
+        std::string key;
+        ss >> key;
+
+        if (key == "simfile") {
+            ss >> std::ws;
+            getline(ss, simfile);
+        } else if (key == "line") {
+            ss >> execline;
+        } else if (key == "seed") {
+            ss >> seed;
+        } else if (key == "written") {
+            ss >> written;
+        } else if (key == "file") {
+            long size;
+            std::string filename;
+            ss >> size >> std::ws;
+            getline(ss, filename);
+            FileSizes[filename] = size;
+        }
+    }
+
+    if (simfile != aSimFile || execline != aLine || (aStartSeed >= 0 && aStartSeed != seed))
+    {
+        std::cerr << "The checkpoint manifest " << name << " belongs to another batch"
+                     " (simfile " << simfile << ", line " << execline << ", seed " << seed << ")\n";
+        exit(1);
+    }
+
+    //  Rows of a run that was stopped while they were written are removed
+    for (auto const& f : FileSizes)
+    {
+        if (f.second < 0)
+        {
+            std::remove(f.first.c_str());
+        }
+        else if (truncate(f.first.c_str(), f.second) != 0)
+        {
+            std::cerr << "Could not restore the output file " << f.first << "\n";
+            exit(1);
+        }
+    }
+
+    aStartSeed = seed;
+    WrittenJobs = written;
+
+    std::cerr << "Resuming the batch after " << written << " written runs\n";
+}
+
+void CScheduler::EnableCheckpoints(const std::string& aPrefix, const std::string& aSimFile, int aLine, int aStartSeed)
+{
+    std::lock_guard<std::mutex> guard(Lock);
+
+    Checkpoints = true;
+    CheckpointPrefix = "data/out/" + aPrefix;
+    SimFile = aSimFile;
+    Line = aLine;
+    StartSeed = aStartSeed;
+
+    writeManifest();
+}
+
+std::string CScheduler::CheckpointFile(int aJobNr) const
+{
+    return CheckpointPrefix + "_run" + std::to_string(aJobNr) + ".ckpt";
+}
+
+std::string CScheduler::spoolFile(const std::string& aFilename, int aJobNr) const
+{
+    return aFilename + "." + std::to_string(aJobNr) + ".part";
+}
+
+//
+//  Starts the simulation as a new thread as soon as one of the slots is free.
+//  The thread deletes the simulation object when the run ends. Runs that are written
+//  already (--resume) and runs submitted after a stop or a failed thread start are not
+//  started. A simulation that runs several repetitions (--shared-burnin) takes aJobs job numbers.
+void CScheduler::Submit(CSimulation* aSim, int aJobs)
+{
+    std::unique_lock<std::mutex> guard(Lock);
+
+    Changed.wait(guard, [this] {
+        return (RunningThreads < MaxThreads && Branches.empty()) || Checkpoint::StopRequested() || Failed;
+    });
+
+    joinEnded();
+
+    aSim->JobNr = SubmittedJobs;
+    aSim->Scheduler = this;
+
+    SubmittedJobs += aJobs;
+
+    if (aSim->JobNr < WrittenJobs || Checkpoint::StopRequested() || Failed)
+    {
+        if (Checkpoints && aSim->JobNr < WrittenJobs)
+        {
+            Checkpoint::Remove(CheckpointFile(aSim->JobNr));   // left if stopped right after its rows were written
+        }
+        delete aSim;
+        return;
+    }
+
+    start(aSim);
+}
+
+//
+//  Called by a running simulation with one of the job numbers it reserved.
+void CScheduler::Branch(CSimulation* aSim, int aJobNr)
+{
+    std::lock_guard<std::mutex> guard(Lock);
+
+    aSim->JobNr = aJobNr;
+    aSim->Scheduler = this;
+
+    Branches.push_back(aSim);
+    startBranches();
+}
+
+//
+//  Must be called with the lock held.
+void CScheduler::startBranches()
+{
+    while (RunningThreads < MaxThreads && !Branches.empty())
+    {
+        CSimulation* sim = Branches.front();
+        Branches.pop_front();
+
+        if (Failed)
+        {
+            delete sim;
+            continue;
+        }
+
+        start(sim);
+    }
+}
+
+//
+//  Must be called with the lock held. If the thread can not be started the run is
+//  dropped and the batch ends with the runs that are running, like after a stop.
+void CScheduler::start(CSimulation* aSim)
+{
+    RunningThreads++;
+
+    try
+    {
+        Threads[aSim->JobNr] = std::thread(&CScheduler::RunLoop, this, aSim);
+    }
+    catch (const std::system_error& e)
+    {
+        std::cerr << "Could not start the thread of run " << aSim->JobNr << ": " << e.what() << "\n";
+
+        RunningThreads--;
+        Threads.erase(aSim->JobNr);
+        Failed = true;
+        delete aSim;
+
+        Changed.notify_all();
+    }
+}
+
+//
+//  The slot is given back after the simulation was deleted, so nothing of it is left
+//  running once WaitAll has seen all slots free.
+void CScheduler::RunLoop(CSimulation* aSim)
+{
+    const int jobNr = aSim->JobNr;
+
+    if (aSim->InitInstance())
+    {
+        aSim->Run();
+        aSim->ExitInstance();
+    }
+    delete aSim;
+
+    std::lock_guard<std::mutex> guard(Lock);
+
+    RunningThreads--;
+    Ended.push_back(jobNr);
+
+    startBranches();
+    Changed.notify_all();
+}
+
+//
+//  Must be called with the lock held. The threads in Ended have left the lock for good.
+void CScheduler::joinEnded()
+{
+    for (int jobNr : Ended)
+    {
+        Threads[jobNr].join();
+        Threads.erase(jobNr);
+    }
+    Ended.clear();
+}
+
+//
+//  Called by the simulation threads. The blocks of a run are written in the order they
+//  are handed over; a run waits here while the writer is too far behind.
+void CScheduler::Append(int aJobNr, std::vector<Output::PendingFile> aRows)
+{
+    std::unique_lock<std::mutex> guard(Lock);
+
+    Changed.wait(guard, [this] { return QueuedBytes < MaxQueuedBytes; });
+
+    for (auto& f : aRows)
+    {
+        QueuedBytes += f.rows.size();
+        Jobs[aJobNr].Queued++;
+        Queue.push_back({ aJobNr, std::move(f) });
+    }
+
+    Changed.notify_all();
+}
+
+//
+//  The run has ended, aRows holds a block for each of its files.
+void CScheduler::Finished(int aJobNr, std::vector<Output::PendingFile> aRows)
+{
+    Append(aJobNr, std::move(aRows));
+
+    std::lock_guard<std::mutex> guard(Lock);
+
+    Jobs[aJobNr].Finished = true;
+    Changed.notify_all();
+}
+
+//
+//  A run that starts from the beginning drops the rows handed over for it before: the copies
+//  of the rows of a shared burn-in that ended early, or the temporary files a run of an
+//  earlier process left behind. A run that continues from its checkpoint keeps the rows
+//  written up to the checkpoint.
+void CScheduler::Discard(int aJobNr, const std::vector<std::string>& aFiles, const std::map<std::string, long>& aKeep)
+{
+    std::unique_lock<std::mutex> guard(Lock);
+
+    Changed.wait(guard, [&] { return Jobs.count(aJobNr) == 0 || Jobs[aJobNr].Queued == 0; });
+
+    for (auto const& f : aFiles)
+    {
+        const std::string spool = spoolFile(f, aJobNr);
+        auto keep = aKeep.find(f);
+
+        if (keep == aKeep.end() || keep->second <= 0)
+        {
+            std::remove(spool.c_str());
+        }
+        else if (truncate(spool.c_str(), keep->second) != 0)
+        {
+            std::cerr << "Could not restore " << spool << " of the checkpoint\n";
+            exit(1);
+        }
+    }
+    Jobs.erase(aJobNr);
+}
+
+//
+//  A checkpoint records how far the rows of its run are written.
+std::map<std::string, long> CScheduler::Written(int aJobNr)
+{
+    std::unique_lock<std::mutex> guard(Lock);
+
+    Changed.wait(guard, [&] { auto job = Jobs.find(aJobNr); return job == Jobs.end() || job->second.Queued == 0; });
+
+    std::map<std::string, long> sizes;
+    auto job = Jobs.find(aJobNr);
+
+    if (job == Jobs.end())
+    {
+        return sizes;
+    }
+
+    for (auto const& f : job->second.Files)
+    {
+        sizes[f.first] = std::max(0L, fileSize(spoolFile(f.first, aJobNr)));
+    }
+
+    return sizes;
+}
+
+//
+//  After a stop the rows of the finished runs are written as far as they are complete.
+bool CScheduler::WaitAll()
+{
+    std::unique_lock<std::mutex> guard(Lock);
+
+    Changed.wait(guard, [this] {
+        return RunningThreads == 0 && (WrittenJobs == SubmittedJobs || Checkpoint::StopRequested() || Failed);
+    });
+
+    joinEnded();
+
+    Closing = true;
+    Changed.notify_all();
+    guard.unlock();
+
+    Writer.join();
+
+    if (WrittenJobs < SubmittedJobs)
+    {
+        return false;
+    }
+
+    if (Checkpoints)
+    {
+        std::remove((CheckpointPrefix + "_checkpoint.txt").c_str());
+    }
+
+    return true;
+}
+
+//
+//  The blocks are written in the order they came; the lock is released while the files are
+//  written. The oldest run that is not written yet appends to the output files, after it took
+//  over what it wrote to its temporary files before. Once all of its rows are written, the
+//  next run takes its place. With checkpoints every run goes through its temporary files,
+//  which are appended when the run is finished: the manifest is written before, with the
+//  sizes of the output files, and after them; then the checkpoint of the run is no longer needed.
+void CScheduler::WriteLoop()
+{
+    std::unique_lock<std::mutex> guard(Lock);
+
+    for (;;)
+    {
+        Changed.wait(guard, [this] { return !Queue.empty() || headFinished() || Closing; });
+
+        if (headFinished())
+        {
+            const int jobNr = WrittenJobs;
+            const std::map<std::string, std::string> files = Jobs[jobNr].Files;
+
+            if (Checkpoints)
+            {
+                for (auto const& f : files)
+                {
+                    if (FileSizes.count(f.first) == 0)
+                    {
+                        FileSizes[f.first] = fileSize(f.first);
+                    }
+                }
+                writeManifest();
+            }
+
+            guard.unlock();
+            const bool written = appendSpool(jobNr, files);
+            guard.lock();
+
+            if (!written)
+            {
+                WriteError = Failed = true;
+                Changed.notify_all();
+                continue;
+            }
+
+            Jobs.erase(jobNr);
+            WrittenJobs++;
+
+            if (Checkpoints)
+            {
+                for (auto const& f : files)
+                {
+                    FileSizes[f.first] = fileSize(f.first);
+                }
+                writeManifest();
+                Checkpoint::Remove(CheckpointFile(jobNr));
+            }
+
+            removeSpool(jobNr, files);
+            Changed.notify_all();
+            continue;
+        }
+
+        if (Queue.empty())
+        {
+            return;
+        }
+
+        Block block = std::move(Queue.front());
+        Queue.pop_front();
+        QueuedBytes -= block.Rows.rows.size();
+
+        JobOutput& job = Jobs[block.JobNr];
+        job.Files[block.Rows.filename] = block.Rows.header;
+
+        const Output::PendingFile& f = block.Rows;
+        const bool direct = !Checkpoints && block.JobNr == WrittenJobs;
+        const bool open = direct && OpenJob != block.JobNr;
+        const std::map<std::string, std::string> files = open ? job.Files : std::map<std::string, std::string>();
+
+        guard.unlock();
+
+        bool written = true;
+
+        if (WriteError)
+        {
+            // the rows are dropped
+        }
+        else if (direct)
+        {
+            if (open)
+            {
+                written = appendSpool(block.JobNr, files);
+                removeSpool(block.JobNr, files);
+                OpenJob = block.JobNr;
+            }
+
+            written = written && writeHeader(f.filename, f.header) &&
+                    (f.rows.empty() || Output::WriteBlock(f.filename, f.rows, Output::IsCompressed(f.filename)));
+        }
+        else if (!f.rows.empty())
+        {
+            written = Output::WriteBlock(spoolFile(f.filename, block.JobNr), f.rows, Output::IsCompressed(f.filename));
+        }
+
+        if (!written)
+        {
+            std::cerr << "Could not write the rows of run " << block.JobNr << " to " << f.filename << "\n";
+        }
+
+        guard.lock();
+
+        Jobs[block.JobNr].Queued--;
+
+        if (!written)
+        {
+            WriteError = Failed = true;
+        }
+
+        Changed.notify_all();
+    }
+}
+
+bool CScheduler::headFinished()
+{
+    auto head = Jobs.find(WrittenJobs);
+
+    return !WriteError && head != Jobs.end() && head->second.Finished && head->second.Queued == 0;
+}
+
+//
+//  A new output file starts with the header.
+bool CScheduler::writeHeader(const std::string& aFilename, const std::string& aHeader)
+{
+    if (!Started.insert(aFilename).second || fileSize(aFilename) > 0)
+    {
+        return true;
+    }
+
+    return Output::WriteBlock(aFilename, aHeader, Output::IsCompressed(aFilename));
+}
+
+//
+//  Appends the temporary files of the run to the output files. Every file of the run gets
+//  its header, also if the run wrote no rows to it.
+bool CScheduler::appendSpool(int aJobNr, const std::map<std::string, std::string>& aFiles)
+{
+    for (auto const& f : aFiles)
+    {
+        if (!writeHeader(f.first, f.second))
+        {
+            std::cerr << "Could not write " << f.first << "\n";
+            return false;
+        }
+
+        std::ifstream spool(spoolFile(f.first, aJobNr).c_str(), std::ios_base::binary);
+
+        if (!spool.is_open() || spool.peek() == EOF)
+        {
+            continue;
+        }
+
+        std::ofstream out(f.first.c_str(), std::ios_base::app | std::ios_base::binary);
+        out << spool.rdbuf();
+        out.close();
+
+        if (out.fail())
+        {
+            std::cerr << "Could not append the rows of run " << aJobNr << " to " << f.first << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CScheduler::removeSpool(int aJobNr, const std::map<std::string, std::string>& aFiles)
+{
+    for (auto const& f : aFiles)
+    {
+        std::remove(spoolFile(f.first, aJobNr).c_str());
+    }
+}
+
+//
+//  Must be called with the lock held. The manifest is replaced as a whole.
+void CScheduler::writeManifest()
+{
+    const std::string name = CheckpointPrefix + "_checkpoint.txt";
+    const std::string temporary = name + ".tmp";
+
+    {
+        std::ofstream manifest(temporary.c_str());
+
+        manifest << ManifestHeader << "\n"
+                 << "simfile " << SimFile << "\n"
+                 << "line " << Line << "\n"
+                 << "seed " << StartSeed << "\n"
+                 << "written " << WrittenJobs << "\n";
+
+        for (auto const& f : FileSizes)
+        {
+            manifest << "file " << f.second << " " << f.first << "\n";
+        }
+    }
+
+    if (std::rename(temporary.c_str(), name.c_str()) != 0)
+    {
+        std::cerr << "Could not write the checkpoint manifest " << name << "\n";
+    }
+}
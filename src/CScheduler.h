@@ -0,0 +1,122 @@
+#ifndef CSCHEDULER_H
+#define CSCHEDULER_H
+
+#include <map>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "Output.h"
+
+class CSimulation;
+
+//
+//  The scheduler runs the simulations of a batch on a limited number of threads.
+//  Every simulation runs on a thread the scheduler owns; the thread deletes the simulation
+//  before it gives its slot back, and WaitAll joins all of them.
+//
+//  The output files are written by a thread of the scheduler. A simulation hands its rows
+//  over in blocks (Output::BlockSize) while it runs, so it neither keeps them in memory
+//  nor waits for the file system. The rows of a run follow the rows of all runs submitted
+//  before it, so the output files are the same regardless of the number of threads: the
+//  oldest run that is not written yet appends its blocks to the output files, the blocks
+//  of the later runs go to a temporary file per run and table (<output file>.<job>.part)
+//  that is appended when their turn comes.
+//
+//  With checkpoints, a manifest records how many runs are written and the sizes of the
+//  output files after them. Runs that are running or waiting keep their state and the
+//  sizes of their temporary files in a checkpoint file each; after a stop, --resume skips
+//  the written runs, cuts the output files back to the manifest and continues the others
+//  from their checkpoints, with their temporary files cut back to the checkpoint. The
+//  manifest is removed when the batch is complete.
+//
+//  With --shared-burnin one simulation stands for all repetitions of a line. It reserves
+//  their job numbers and hands the branches to the scheduler at the end of its burn-in;
+//  they get the next free slots, before the simulations submitted after them.
+class CScheduler
+{
+public:
+    CScheduler(int aMaxThreads);
+    ~CScheduler();
+
+    void Resume(const std::string& aPrefix, const std::string& aSimFile, int aLine, int& aStartSeed); // reads the manifest
+    void EnableCheckpoints(const std::string& aPrefix, const std::string& aSimFile, int aLine, int aStartSeed);
+    std::string CheckpointFile(int aJobNr) const;
+
+    void Submit(CSimulation* aSim, int aJobs = 1);                  // blocks until a thread slot is free
+    void Branch(CSimulation* aSim, int aJobNr);                     // a reserved job, started as soon as possible
+    void Append(int aJobNr, std::vector<Output::PendingFile> aRows);   // blocks while too many rows wait for the writer
+    void Finished(int aJobNr, std::vector<Output::PendingFile> aRows); // the last rows of the run
+    void Discard(int aJobNr, const std::vector<std::string>& aFiles,   // removes the rows handed over so far,
+                 const std::map<std::string, long>& aKeep = std::map<std::string, long>()); // but the first aKeep bytes
+    std::map<std::string, long> Written(int aJobNr);                   // waits for the writer, the sizes of the
+                                                                       // temporary files of the run (checkpoints)
+    bool WaitAll();                                                 // blocks until every submitted run is written,
+                                                                    // false if the batch was stopped or failed before
+    int NextJobNr() { return SubmittedJobs; }
+private:
+    void WriteLoop();                               // body of the writer thread
+    void RunLoop(CSimulation* aSim);                // body of a simulation thread
+    void writeManifest();
+    void startBranches();
+    void start(CSimulation* aSim);
+    void joinEnded();
+    bool headFinished();                            // all rows of the oldest unwritten run are handed over and written
+    std::string spoolFile(const std::string& aFilename, int aJobNr) const;
+    bool writeHeader(const std::string& aFilename, const std::string& aHeader);
+    bool appendSpool(int aJobNr, const std::map<std::string, std::string>& aFiles);
+    void removeSpool(int aJobNr, const std::map<std::string, std::string>& aFiles);
+
+    std::deque<CSimulation*> Branches;              // waiting for a free slot
+
+    int MaxThreads;
+    int RunningThreads;
+    int SubmittedJobs;
+    int WrittenJobs;
+    bool Failed;                                    // a thread could not be started or an output file not
+                                                    // be written, no further runs start
+
+    std::map<int, std::thread> Threads;             // the simulation threads by job number
+    std::vector<int> Ended;                         // threads that are done and can be joined
+
+    struct Block
+    {
+        int JobNr;
+        Output::PendingFile Rows;
+    };
+
+    struct JobOutput
+    {
+        std::map<std::string, std::string> Files;   // the output files of the run and their headers
+        int Queued = 0;                             // blocks not written yet
+        bool Finished = false;                      // all its blocks are handed over
+    };
+
+    static const size_t MaxQueuedBytes = 16 * Output::BlockSize;
+
+    std::deque<Block> Queue;                        // blocks waiting for the writer, of all runs in the order they came
+    size_t QueuedBytes;
+    std::map<int, JobOutput> Jobs;                  // the runs that handed over rows and are not written yet
+
+    // owned by the writer thread
+    int OpenJob;                                    // the run that appends to the output files directly
+    bool WriteError;                                // no further rows are written
+    std::set<std::string> Started;                  // output files that have their header
+
+    bool Checkpoints;
+    std::string CheckpointPrefix;                   // data/out/<output prefix>
+    std::string SimFile;
+    int Line;
+    int StartSeed;
+    std::map<std::string, long> FileSizes;          // output files and their sizes after the written runs, -1: none
+
+    bool Closing;                                   // WaitAll: the writer ends once it has nothing left to write
+
+    std::mutex Lock;
+    std::condition_variable Changed;
+    std::thread Writer;                             // started last, it uses the members above
+};
+
+#endif // CSCHEDULER_H
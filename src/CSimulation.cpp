@@ -1,3 +1,6 @@
+#include <iostream>
+#include <sstream>
+
 #include "CThread.h"
 #include "itv_mode.h"
 #include "Grid.h"
@@ -5,8 +8,205 @@
 #include "GridEnvir.h"
 #include "Parameters.h"
 #include "CSimulation.h"
+#include "CScheduler.h"
+#include "Checkpoint.h"
+#include "RandomGenerator.h"
+
+CSimulation::CSimulation() : JobNr(-1), Scheduler(0), Repetitions(1)
+{
+
+}
+
+//
+//  The settings carry the values given on the command line; the SimFile line is read on top of them.
+//  With aRepetitions > 1 the run is the first of as many repetitions that share its burn-in.
+CSimulation::CSimulation(const Parameters& aSettings, const std::string& aSimLine, int aRunNr, int aRepetitions) :
+    JobNr(-1), Scheduler(0), SimLine(aSimLine), Settings(aSettings), Repetitions(aRepetitions)
+{
+    Parameters::operator=(aSettings);
+    RunNr = aRunNr;
+}
 
-CSimulation::CSimulation()
+//
+//  The thread body. With --resume the run continues from its checkpoint, if it has one.
+int CSimulation::Run()
 {
+    GetSim(SimLine);
+
+    rng.seed(startSeed, SimID, ComNr, RunNr, generator);
+
+    std::cout << getSimID() << std::endl;
+    std::cout << "Run " << RunNr << " \n";
+
+    if (Scheduler != 0 && checkpointYears >= 0)
+    {
+        CheckpointFn = Scheduler->CheckpointFile(JobNr);
+    }
+
+    //  A branch of a shared burn-in got the rows of the burn-in handed over already. The rows
+    //  written after the checkpoint are dropped, of a run from the beginning all of them.
+    if (Snapshot)
+    {
+        CheckpointReader reader(Snapshot);
+        BranchRun(reader);
+
+        Snapshot.reset();
+    }
+    else if (resume && !CheckpointFn.empty() && Checkpoint::Exists(CheckpointFn))
+    {
+        CheckpointReader reader(CheckpointFn);
+
+        Checkpoint::Kind kind = reader.ReadHeader(identity());
+        Scheduler->Discard(JobNr, output.Filenames(), reader.Read<std::map<std::string, long> >());
+
+        if (kind == Checkpoint::Finished)
+        {
+            FinishedRows = output.TakeRows();
+            return 0;
+        }
+
+        ResumeRun(reader);
+    }
+    else
+    {
+        if (Scheduler != 0)
+        {
+            Scheduler->Discard(JobNr, output.Filenames());
+        }
+
+        InitRun();
+    }
+
+    //  Without a branch point the repetitions do not share anything
+    if (Repetitions > 1 && !hasBranchPoint())
+    {
+        startRepetitions(nullptr);
+    }
+
+    OneRun();
+
+    //  The run ended before its burn-in did, the others start from the beginning
+    if (Repetitions > 1)
+    {
+        startRepetitions(nullptr);
+    }
+
+    if (!Interrupted)
+    {
+        //  Until the scheduler has appended its temporary files, the checkpoint keeps their sizes
+        if (!CheckpointFn.empty())
+        {
+            writeRows();
+
+            CheckpointWriter writer(CheckpointFn);
+            writer.WriteHeader(Checkpoint::Finished, identity());
+            writer.Write(Scheduler->Written(JobNr));
+            writer.Commit();
+        }
+
+        FinishedRows = output.TakeRows();
+    }
+
+    return 0;
+}
+
+//
+//  A run that was stopped has nothing to hand over, it continues from its checkpoint.
+void CSimulation::ExitInstance()
+{
+    if (Scheduler == 0 || Interrupted)
+    {
+        return;
+    }
+
+    Scheduler->Finished(JobNr, std::move(FinishedRows));
+}
+
+//
+//  The rows go to the writer whenever a block is full.
+void CSimulation::WriteOutput()
+{
+    if (Scheduler == 0 || !output.BlockFull())
+    {
+        return;
+    }
+
+    writeRows();
+}
+
+//
+//  The burn-in of several repetitions hands copies of its rows to the others, under their IDs.
+void CSimulation::writeRows()
+{
+    for (int i = 1; i < Repetitions; i++)
+    {
+        Scheduler->Append(JobNr + i, output.CopyRows(getSimID(), getSimID(RunNr + i)));
+    }
+
+    Scheduler->Append(JobNr, output.TakeRows());
+}
+
+void CSimulation::SaveCheckpoint(int aYear, int aWeek)
+{
+    if (CheckpointFn.empty())
+    {
+        return;
+    }
+
+    //  The rows so far go to the temporary files, the checkpoint keeps their sizes
+    writeRows();
+
+    CheckpointWriter writer(CheckpointFn);
+    writer.WriteHeader(Checkpoint::Running, identity());
+    writer.Write(Scheduler->Written(JobNr));
+    SaveRun(writer, aYear, aWeek);
+    writer.Commit();
+}
+
+//
+//  The end of the burn-in. This run continues as the first repetition, the others
+//  branch from a snapshot of its state.
+void CSimulation::Branch()
+{
+    if (Repetitions < 2)
+    {
+        return;
+    }
+
+    //  the snapshot holds no rows
+    writeRows();
+
+    CheckpointWriter writer;
+    SaveRun(writer, year, week);
+
+    startRepetitions(std::make_shared<const std::string>(writer.Snapshot()));
+}
+
+void CSimulation::startRepetitions(const std::shared_ptr<const std::string>& aSnapshot)
+{
+    for (int i = 1; i < Repetitions; i++)
+    {
+        CSimulation* sim = new CSimulation(Settings, SimLine, RunNr + i);
+
+        sim->Snapshot = aSnapshot;
+
+        Scheduler->Branch(sim, JobNr + i);
+    }
+
+    Repetitions = 1;
+}
+
+//
+//  A run resumes only from a checkpoint of the same SimFile line and command line settings.
+std::string CSimulation::identity() const
+{
+    std::ostringstream ss;
+
+    ss << SimLine << "\n"
+       << "run " << RunNr << " seed " << startSeed << " rng " << generator
+       << " coverage " << coverage << " grazing " << grazing << " profile " << profile
+       << " gridsize " << GridSize << " competition " << AboveCompMode << " " << BelowCompMode
+       << " output " << format << " compress " << compressed;
 
+    return ss.str();
 }
@@ -1,11 +1,36 @@
 #ifndef CSIMULATION_H
 #define CSIMULATION_H
 
+#include <memory>
+
+class CScheduler;
 
 class CSimulation : public GridEnvir
 {
 public:
     CSimulation();
+    CSimulation(const Parameters& aSettings, const std::string& aSimLine, int aRunNr, int aRepetitions = 1);
+
+    virtual int Run();
+    virtual void ExitInstance();
+
+    int JobNr;               // position of this run in the batch, set by the scheduler
+    CScheduler* Scheduler;
+protected:
+    virtual void SaveCheckpoint(int aYear, int aWeek);
+    virtual void Branch();
+    virtual void WriteOutput();
+private:
+    std::string SimLine;     // line of the SimFile this run is parameterized with
+    Parameters Settings;     // the command line settings, for the branches
+    int Repetitions;         // > 1: this run is the burn-in of as many repetitions (--shared-burnin)
+    std::shared_ptr<const std::string> Snapshot;    // a branch: the state at the end of the burn-in
+    std::string CheckpointFn;                       // empty without checkpoints
+    std::vector<Output::PendingFile> FinishedRows;  // the rows of the run once it is finished
+
+    std::string identity() const;
+    void writeRows();                               // hands the buffered rows to the writer
+    void startRepetitions(const std::shared_ptr<const std::string>& aSnapshot); // the other repetitions, from the beginning without a snapshot
 };
 
 #endif // CSIMULATION_H
@@ -121,13 +121,16 @@ bool CThread::InitInstance() {
 //  Copyrights by Hans-Juergen Lange. All rights reserved.
 //
 // **************************************************************************
-void CThread::Create() {
+bool CThread::Create() {
     pthread_attr_t attr;
+    int result;
     
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-    pthread_create(&ThreadID, &attr, startfnc, (void *)(this));
+    result = pthread_create(&ThreadID, &attr, startfnc, (void *)(this));
+    pthread_attr_destroy(&attr);
     
+    return (result == 0);
 }
 // **************************************************************************
 //
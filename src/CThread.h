@@ -29,7 +29,7 @@ public:
     CThread(const std::string& aName);
     virtual ~CThread();
     virtual bool InitInstance();
-    void Create();
+    bool Create();      // false if the thread could not be started
     virtual int Run();
     virtual void ExitInstance();
     void SetName(const std::string& aName);
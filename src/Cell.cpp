@@ -6,8 +6,6 @@
 #include "itv_mode.h"
 #include "Cell.h"
 #include "RandomGenerator.h"
-#include "Output.h"
-#include "IBC-grass.h"
 
 using namespace std;
 
@@ -32,6 +30,8 @@ Cell::~Cell()
 
     SeedBankList.clear();
     SeedlingList.clear();
+    SeedCohortList.clear();
+    SeedlingCohortList.clear();
 
     PftNIndA.clear();
     PftNIndB.clear();
@@ -48,6 +48,7 @@ void Cell::weeklyReset()
     PftNIndB.clear();
 
     SeedlingList.clear();
+    SeedlingCohortList.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -60,15 +61,17 @@ void Cell::SetResource(double Ares, double Bres)
 
 //-----------------------------------------------------------------------------
 
-double Cell::Germinate()
+double Cell::Germinate(RandomGenerator& aRng)
 {
     double sum_SeedMass = 0;
 
+    const double* u = aRng.get01Batch(SeedBankList.size());
+
     auto it = SeedBankList.begin();
     while ( it != SeedBankList.end() )
     {
         auto & seed = *it;
-        if (rng.get01() < seed->pEstab)
+        if (*u++ < seed->pEstab)
         {
             sum_SeedMass += seed->mass;
             SeedlingList.push_back(std::move(seed)); // This seed germinates, add it to seedlings
@@ -80,6 +83,27 @@ double Cell::Germinate()
         }
     }
 
+    // Seeds without ITV germinate as a binomial number of each cohort
+    for (auto & cohort : SeedCohortList)
+    {
+        int n = aRng.getBinomial(cohort.count, cohort.pEstab);
+
+        if (n > 0)
+        {
+            sum_SeedMass += n * cohort.mass;
+
+            SeedlingCohortList.push_back(cohort);
+            SeedlingCohortList.back().count = n;
+
+            cohort.count -= n;
+        }
+    }
+
+    SeedCohortList.erase(
+            std::remove_if(SeedCohortList.begin(), SeedCohortList.end(),
+                    [] (const SeedCohort & c) { return c.count == 0; }),
+            SeedCohortList.end());
+
     return sum_SeedMass;
 }
 
@@ -90,39 +114,93 @@ void Cell::RemoveSeeds()
     SeedBankList.erase(
             std::remove_if(SeedBankList.begin(), SeedBankList.end(), Seed::GetSeedRemove),
             SeedBankList.end());
+
+    SeedCohortList.erase(
+            std::remove_if(SeedCohortList.begin(), SeedCohortList.end(),
+                    [] (const SeedCohort & c) { return c.count == 0; }),
+            SeedCohortList.end());
+}
+
+//-----------------------------------------------------------------------------
+
+void Cell::AddSeeds(int aPft, double aPEstab, double aMass, int aCount)
+{
+    for (auto & cohort : SeedCohortList)
+    {
+        if (cohort.age == 0 && cohort.pft == aPft && cohort.pEstab == aPEstab)
+        {
+            cohort.count += aCount;
+            return;
+        }
+    }
+
+    SeedCohortList.push_back(SeedCohort{aPft, aPEstab, aMass, 0, aCount});
+}
+
+//-----------------------------------------------------------------------------
+
+int Cell::GetNSeeds() const
+{
+    int n = int(SeedBankList.size());
+
+    for (auto const& cohort : SeedCohortList)
+    {
+        n += cohort.count;
+    }
+
+    return n;
 }
 
 //-----------------------------------------------------------------------------
-#if 0
 
-void Cell::AboveComp()
+int Cell::GetNSeedlings() const
+{
+    int n = int(SeedlingList.size());
+
+    for (auto const& cohort : SeedlingCohortList)
+    {
+        n += cohort.count;
+    }
+
+    return n;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Any combination of competition modes and stabilization versions, in the way of the
+ * specialized cells below. Total asymmetry: the largest plant of the cell takes all
+ * the resource (by shoot geometry above ground, by root mass below ground).
+ */
+void CellCompetition::AboveComp()
 {
     if (AbovePlantList.empty())
         return;
 
-    if (Parameters::params.AboveCompMode == asymtot)
+    if (AboveMode == asymtot)
     {
-        weak_ptr<Plant> p_ptr =
-                *std::max_element(AbovePlantList.begin(), AbovePlantList.end(),
-                        [](const weak_ptr<Plant> & a, const weak_ptr<Plant> & b)
-                        {
-                            auto _a = a.lock();
-                            auto _b = b.lock();
-
-                            return Plant::getShootGeometry(_a) < Plant::getShootGeometry(_b);
-                        });
+        shared_ptr<Plant> winner;
+        double largest = 0;
 
-        auto p = p_ptr.lock();
+        for (auto const& plant_ptr : AbovePlantList)
+        {
+            auto plant = plant_ptr.lock();
+            assert(plant);
 
-        assert(p);
+            double size = Plant::getShootGeometry(plant);
+            if (!winner || size > largest)
+            {
+                winner = plant;
+                largest = size;
+            }
+        }
 
-        p->Auptake += AResConc;
+        winner->Auptake() += AResConc;
 
         return;
     }
 
     int symm;
-    if (Parameters::params.AboveCompMode == asympart)
+    if (AboveMode == asympart)
     {
         symm = 2;
     }
@@ -139,7 +217,7 @@ void Cell::AboveComp()
     {
         auto plant = plant_ptr.lock();
 
-        comp_tot += plant->comp_coef(1, symm) * prop_res(plant->pft(), 1, Parameters::params.stabilization);
+        comp_tot += plant->comp_coef(1, symm) * prop_res(plant->pft(), 1);
     }
 
     //2. distribute resources
@@ -148,8 +226,8 @@ void Cell::AboveComp()
         auto plant = plant_ptr.lock();
         assert(plant);
 
-        comp_c = plant->comp_coef(1, symm) * prop_res(plant->pft(), 1, Parameters::params.stabilization);
-        plant->Auptake += AResConc * comp_c / comp_tot;
+        comp_c = plant->comp_coef(1, symm) * prop_res(plant->pft(), 1);
+        plant->Auptake() += AResConc * comp_c / comp_tot;
     }
 
     aComp_weekly = comp_tot;
@@ -157,15 +235,36 @@ void Cell::AboveComp()
 
 //-----------------------------------------------------------------------------
 
-void Cell::BelowComp()
+void CellCompetition::BelowComp()
 {
-    assert(Parameters::params.BelowCompMode != asymtot);
-
     if (BelowPlantList.empty())
         return;
 
+    if (BelowMode == asymtot)
+    {
+        shared_ptr<Plant> winner;
+        double largest = 0;
+
+        for (auto const& plant_ptr : BelowPlantList)
+        {
+            auto plant = plant_ptr.lock();
+            assert(plant);
+
+            double size = plant->mRoot();
+            if (!winner || size > largest)
+            {
+                winner = plant;
+                largest = size;
+            }
+        }
+
+        winner->Buptake() += BResConc;
+
+        return;
+    }
+
     int symm;
-    if (Parameters::params.BelowCompMode == asympart)
+    if (BelowMode == asympart)
     {
         symm = 2;
     }
@@ -183,7 +282,7 @@ void Cell::BelowComp()
         auto plant = plant_ptr.lock();
         assert(plant);
 
-        comp_tot += plant->comp_coef(2, symm) * prop_res(plant->pft(), 2, Parameters::params.stabilization);
+        comp_tot += plant->comp_coef(2, symm) * prop_res(plant->pft(), 2);
     }
 
     //2. distribute resources
@@ -191,8 +290,8 @@ void Cell::BelowComp()
     {
         auto plant = plant_ptr.lock();
 
-        comp_c = plant->comp_coef(2, symm) * prop_res(plant->pft(), 2, Parameters::params.stabilization);
-        plant->Buptake += BResConc * comp_c / comp_tot;
+        comp_c = plant->comp_coef(2, symm) * prop_res(plant->pft(), 2);
+        plant->Buptake() += BResConc * comp_c / comp_tot;
     }
 
     bComp_weekly = comp_tot;
@@ -200,14 +299,14 @@ void Cell::BelowComp()
 
 //---------------------------------------------------------------------------
 
-double Cell::prop_res(const string& type, const int layer, const int version) const
+double CellCompetition::prop_res(const string& type, const int layer) const
 {
-    switch (version)
+    switch (Stabilization)
     {
-    case 0:
+    case version1:
         return 1;
         break;
-    case 1:
+    case version2:
         if (layer == 1)
         {
             map<string, int>::const_iterator noa = PftNIndA.find(type);
@@ -225,7 +324,7 @@ double Cell::prop_res(const string& type, const int layer, const int version) co
             }
         }
         break;
-    case 2:
+    case version3:
         if (layer == 1)
         {
             return PftNIndA.size() / (1.0 + PftNIndA.size());
@@ -236,13 +335,14 @@ double Cell::prop_res(const string& type, const int layer, const int version) co
         }
         break;
     default:
-        cerr << "CCell::prop_res() - wrong input";
+        cerr << "CellCompetition::prop_res() - wrong input";
         exit(3);
         break;
     }
     return -1;
 }
-#endif
+
+//---------------------------------------------------------------------------
 
 void CellAsymPartSymV1::AboveComp() {
     if (AbovePlantList.empty())
@@ -266,7 +366,7 @@ void CellAsymPartSymV1::AboveComp() {
         assert(plant);
 
         comp_c = plant->comp_coef(1, 2);
-        plant->Auptake += AResConc * comp_c / comp_tot;
+        plant->Auptake() += AResConc * comp_c / comp_tot;
     }
 
     aComp_weekly = comp_tot;
@@ -294,7 +394,7 @@ void CellAsymPartSymV1::BelowComp() {
         auto plant = plant_ptr.lock();
 
         comp_c = plant->comp_coef(2, 1);
-        plant->Buptake += BResConc * comp_c / comp_tot;
+        plant->Buptake() += BResConc * comp_c / comp_tot;
     }
 
     bComp_weekly = comp_tot;
@@ -322,7 +422,7 @@ void CellAsymPartSymV2::AboveComp() {
         assert(plant);
 
         comp_c = plant->comp_coef(1, 2) * prop_res_above(plant->pft());
-        plant->Auptake += AResConc * comp_c / comp_tot;
+        plant->Auptake() += AResConc * comp_c / comp_tot;
     }
 
     aComp_weekly = comp_tot;
@@ -350,7 +450,7 @@ void CellAsymPartSymV2::BelowComp() {
         auto plant = plant_ptr.lock();
 
         comp_c = plant->comp_coef(2, 1) * prop_res_below(plant->pft());
-        plant->Buptake += BResConc * comp_c / comp_tot;
+        plant->Buptake() += BResConc * comp_c / comp_tot;
     }
 
     bComp_weekly = comp_tot;
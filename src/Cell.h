@@ -6,6 +6,9 @@
 
 #include "Plant.h"
 #include "Seed.h"
+#include "Parameters.h"
+
+class RandomGenerator;
 
 class Cell
 {
@@ -28,6 +31,9 @@ public:
     std::vector< std::unique_ptr<Seed> > SeedBankList; // List of all (ungerminated) seeds in the cell
     std::vector< std::unique_ptr<Seed> > SeedlingList; // List of all freshly germinated seedlings in the cell
 
+    std::vector< SeedCohort > SeedCohortList;     // seed bank without ITV: numbers of identical seeds
+    std::vector< SeedCohort > SeedlingCohortList; // freshly germinated seedlings without ITV
+
     std::map<std::string, int> PftNIndA; // Plants covering the cell aboveground
     std::map<std::string, int> PftNIndB; // Plants covering the cell belowground
 
@@ -38,8 +44,13 @@ public:
 
     void weeklyReset();
     void SetResource(double Ares, double Bres);
-    double Germinate();
+    double Germinate(RandomGenerator& aRng);
     void RemoveSeeds();
+    void AddSeeds(int aPft, double aPEstab, double aMass, int aCount); // new seeds (age 0) without ITV
+    int GetNSeeds() const;
+    int GetNSeedlings() const;
+
+    inline bool hasSeeds() const { return !SeedBankList.empty() || !SeedCohortList.empty(); }
 
     /* competition function for size symmetric above-ground resource competition
      * function is overwritten if inherited class with different competitive
@@ -84,5 +95,26 @@ private:
     virtual double prop_res_above(const std::string & type);
     virtual double prop_res_below(const std::string& type);
 };
+
+// all other combinations of above- and belowground competition modes
+class CellCompetition : public Cell {
+public:
+    CellCompetition(const unsigned int xx,
+                    const unsigned int yy,
+                    CompMode aAboveMode, CompMode aBelowMode,
+                    stabilizationMode aStabilization) :
+                        Cell(xx,yy),
+                        AboveMode(aAboveMode), BelowMode(aBelowMode),
+                        Stabilization(aStabilization) {};
+    virtual ~CellCompetition() {};
+    virtual void AboveComp();
+    virtual void BelowComp();
+private:
+    const CompMode AboveMode;
+    const CompMode BelowMode;
+    const stabilizationMode Stabilization;
+
+    double prop_res(const std::string& type, const int layer) const; // stabilization factor
+};
 //---------------------------------------------------------------------------
 #endif
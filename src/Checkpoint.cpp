@@ -0,0 +1,177 @@
+#include <iostream>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include "Checkpoint.h"
+
+using namespace std;
+
+const char Checkpoint::Magic[] = "IBC-grass checkpoint";
+const uint32_t Checkpoint::Version = 3;
+
+static std::atomic<int> stopRequested(0);
+
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+//-----------------------------------------------------------------------------
+
+void Checkpoint::CatchSignals()
+{
+    std::signal(SIGTERM, requestStop);
+}
+
+//-----------------------------------------------------------------------------
+
+bool Checkpoint::StopRequested()
+{
+    return stopRequested != 0;
+}
+
+//-----------------------------------------------------------------------------
+
+bool Checkpoint::Exists(const string & aFilename)
+{
+    std::ifstream file(aFilename.c_str());
+    return file.good();
+}
+
+//-----------------------------------------------------------------------------
+
+void Checkpoint::Remove(const string & aFilename)
+{
+    std::remove(aFilename.c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+CheckpointWriter::CheckpointWriter() :
+        Memory(ios_base::binary),
+        Stream(Memory)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+
+CheckpointWriter::CheckpointWriter(const string & aFilename) :
+        Filename(aFilename),
+        File((aFilename + ".tmp").c_str(), ios_base::binary | ios_base::trunc),
+        Stream(File)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+
+void CheckpointWriter::Write(const string & aValue)
+{
+    Write(uint64_t(aValue.size()));
+    Stream.write(aValue.data(), aValue.size());
+}
+
+//-----------------------------------------------------------------------------
+
+void CheckpointWriter::WriteHeader(Checkpoint::Kind aKind, const string & aIdentity)
+{
+    Stream.write(Checkpoint::Magic, sizeof(Checkpoint::Magic));
+    Write(Checkpoint::Version);
+    Write(int32_t(aKind));
+    Write(aIdentity);
+}
+
+//-----------------------------------------------------------------------------
+
+bool CheckpointWriter::Commit()
+{
+    File.close();
+
+    const string temporary = Filename + ".tmp";
+
+    if (File.fail() || std::rename(temporary.c_str(), Filename.c_str()) != 0)
+    {
+        cerr << "Could not write checkpoint " << Filename << endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+string CheckpointWriter::Snapshot() const
+{
+    return Memory.str();
+}
+
+//-----------------------------------------------------------------------------
+
+CheckpointReader::CheckpointReader(const string & aFilename) :
+        Filename(aFilename),
+        File(aFilename.c_str(), ios_base::binary),
+        Stream(File)
+{
+    check();
+}
+
+//-----------------------------------------------------------------------------
+
+CheckpointReader::CheckpointReader(const shared_ptr<const string> & aSnapshot) :
+        Filename("snapshot"),
+        Memory(*aSnapshot, ios_base::binary),
+        Stream(Memory)
+{
+    check();
+}
+
+//-----------------------------------------------------------------------------
+
+void CheckpointReader::check()
+{
+    if (!Stream.good())
+    {
+        cerr << "Could not read checkpoint " << Filename << endl;
+        exit(1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void CheckpointReader::Read(string & aValue)
+{
+    aValue.resize(Read<uint64_t>());
+    Stream.read(&aValue[0], aValue.size());
+    check();
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Exits if the file is no checkpoint of this version or belongs to another run.
+ */
+Checkpoint::Kind CheckpointReader::ReadHeader(const string & aIdentity)
+{
+    char magic[sizeof(Checkpoint::Magic)];
+    Stream.read(magic, sizeof(magic));
+    check();
+
+    if (memcmp(magic, Checkpoint::Magic, sizeof(magic)) != 0 || Read<uint32_t>() != Checkpoint::Version)
+    {
+        cerr << Filename << " is no checkpoint of this version" << endl;
+        exit(1);
+    }
+
+    Checkpoint::Kind kind = Checkpoint::Kind(Read<int32_t>());
+
+    if (Read<string>() != aIdentity)
+    {
+        cerr << "Checkpoint " << Filename << " was written by another run or with other settings" << endl;
+        exit(1);
+    }
+
+    return kind;
+}
@@ -0,0 +1,150 @@
+#ifndef SRC_CHECKPOINT_H_
+#define SRC_CHECKPOINT_H_
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include <type_traits>
+
+//! Binary snapshot of a run, to continue it after the process was stopped (--checkpoint, --resume)
+/*! A checkpoint file starts with a magic string, the format version, its kind and the identity
+ of the run (SimFile line and command line settings); a run only resumes from a checkpoint of
+ the same identity. Values are written in the byte order of the machine, so a checkpoint is
+ read back on the same kind of machine it was written on.
+
+ The files are written next to their final name and renamed when complete, so a process
+ that is killed while writing leaves the previous checkpoint intact. The same format serves
+ as the in-memory snapshot the repetitions of a line branch from (--shared-burnin).
+ */
+class Checkpoint
+{
+
+public:
+    static const char Magic[];
+    static const uint32_t Version;
+
+    enum Kind
+    {
+        Running,                // the state of a run, continues with the week stored in it
+        Finished                // the output rows of a finished run that were not written yet
+    };
+
+    static void CatchSignals();     // SIGTERM requests a stop at the end of the current week
+    static bool StopRequested();
+
+    static bool Exists(const std::string & aFilename);
+    static void Remove(const std::string & aFilename);
+};
+
+//-----------------------------------------------------------------------------
+
+class CheckpointWriter
+{
+
+private:
+    std::string Filename;           // empty for a snapshot in memory
+    std::ofstream File;
+    std::ostringstream Memory;
+    std::ostream & Stream;
+
+public:
+    CheckpointWriter();             // writes a snapshot into memory
+    CheckpointWriter(const std::string & aFilename);
+
+    template <typename T>
+    void Write(const T & aValue)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are written as bytes");
+        Stream.write(reinterpret_cast<const char*>(&aValue), sizeof(T));
+    }
+
+    void Write(const std::string & aValue);
+
+    template <typename T>
+    void Write(const std::vector<T> & aValues)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are written as bytes");
+        Write(uint64_t(aValues.size()));
+        Stream.write(reinterpret_cast<const char*>(aValues.data()), aValues.size() * sizeof(T));
+    }
+
+    template <typename K, typename V>
+    void Write(const std::map<K, V> & aValues)
+    {
+        Write(uint64_t(aValues.size()));
+        for (auto const& it : aValues)
+        {
+            Write(it.first);
+            Write(it.second);
+        }
+    }
+
+    void WriteHeader(Checkpoint::Kind aKind, const std::string & aIdentity);
+    bool Commit();                  // closes the file and moves it to its name
+    std::string Snapshot() const;   // what was written into memory
+};
+
+//-----------------------------------------------------------------------------
+
+class CheckpointReader
+{
+
+private:
+    std::string Filename;
+    std::ifstream File;
+    std::istringstream Memory;
+    std::istream & Stream;
+
+    void check();                   // exits with a message if the file ended or could not be read
+
+public:
+    CheckpointReader(const std::string & aFilename);
+    CheckpointReader(const std::shared_ptr<const std::string> & aSnapshot);
+
+    template <typename T>
+    void Read(T & aValue)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are read as bytes");
+        Stream.read(reinterpret_cast<char*>(&aValue), sizeof(T));
+        check();
+    }
+
+    template <typename T>
+    T Read()
+    {
+        T value;
+        Read(value);
+        return value;
+    }
+
+    void Read(std::string & aValue);
+
+    template <typename T>
+    void Read(std::vector<T> & aValues)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are read as bytes");
+        aValues.resize(Read<uint64_t>());
+        Stream.read(reinterpret_cast<char*>(aValues.data()), aValues.size() * sizeof(T));
+        check();
+    }
+
+    template <typename K, typename V>
+    void Read(std::map<K, V> & aValues)
+    {
+        aValues.clear();
+        for (uint64_t n = Read<uint64_t>(); n > 0; n--)
+        {
+            K key;
+            Read(key);
+            Read(aValues[key]);
+        }
+    }
+
+    Checkpoint::Kind ReadHeader(const std::string & aIdentity);
+};
+
+#endif
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+#include "itv_mode.h"
+#include "Traits.h"
+#include "Plant.h"
+#include "RandomGenerator.h"
+#include "DispersalKernel.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+DispersalKernel::DispersalKernel() : GridSize(0)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * One table per PFT; PFTs with the same dispersal distance share the computation.
+ */
+void DispersalKernel::Init(long aGridSize, const TraitTable & aTraits)
+{
+    GridSize = aGridSize;
+    Tables.assign(aTraits.pftByNr.size(), Table());
+
+    for (unsigned int i = 0; i < aTraits.pftByNr.size(); i++)
+    {
+        const double dist = aTraits.pftByNr[i]->dispersalDist;
+
+        unsigned int same = 0;
+        while (same < i && aTraits.pftByNr[same]->dispersalDist != dist)
+        {
+            same++;
+        }
+
+        if (same < i)
+        {
+            Tables[i] = Tables[same];
+        }
+        else
+        {
+            buildTable(Tables[i], dist * 100, dist * 100); // meters -> cm, mean = std (as in Grid::DisperseSeeds)
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Discretizes the kernel of Grid::getTargetCell(): a seed lands on the cell its displacement
+ * rounds to, i.e. a cell receives the integral of the two-dimensional kernel density over the
+ * unit square around it.
+ * - near field, offsets up to the distance that 99.9% of the seeds stay within: midpoint
+ *   rule with up to 8x8 points per cell (one quadrant, mirrored), wrapped onto the torus
+ * - far field beyond: polar quadrature with narrow bins of the log-distance (up to 6 sigma),
+ *   each spread over evenly spaced directions
+ */
+void DispersalKernel::buildTable(Table & aTable, const float mean, const float sd)
+{
+    const double sigma = std::sqrt(std::log((sd / mean) * (sd / mean) + 1));
+    const double mu = std::log(mean) - 0.5 * sigma;
+
+    const double range = 6.0;
+    const int near = min(2048, int(ceil(exp(mu + 3.1 * sigma))));
+
+    vector<double> p(GridSize * GridSize, 0);
+
+    auto add = [this, &p] (long dx, long dy, double w)
+    {
+        dx %= GridSize;
+        dy %= GridSize;
+        if (dx < 0) dx += GridSize;
+        if (dy < 0) dy += GridSize;
+
+        p[dx * GridSize + dy] += w;
+    };
+
+    // density of the displacement in the plane: lognormal density of the distance / (2 Pi r)
+    auto density = [mu, sigma] (double x, double y)
+    {
+        const double r2 = x * x + y * y;
+        const double z = (0.5 * std::log(r2) - mu) / sigma;
+        return std::exp(-0.5 * z * z) / (2 * Pi * sigma * std::sqrt(2 * Pi) * r2);
+    };
+
+    // 1. near field, fewer points per cell where the density is smooth
+    for (int i = 0; i <= near; i++)
+    {
+        for (int j = 0; j <= near; j++)
+        {
+            const double r = std::sqrt(double(i * i + j * j));
+            const int sub = r < 16 ? 8 : r < 64 ? 4 : 2;
+
+            double w = 0;
+            for (int a = 0; a < sub; a++)
+            {
+                for (int b = 0; b < sub; b++)
+                {
+                    w += density(i - 0.5 + (a + 0.5) / sub, j - 0.5 + (b + 0.5) / sub);
+                }
+            }
+            w /= sub * sub;
+
+            add(i, j, w);
+            if (i > 0) add(-i, j, w);
+            if (j > 0) add(i, -j, w);
+            if (i > 0 && j > 0) add(-i, -j, w);
+        }
+    }
+
+    // 2. far field
+    const int nBins = 1200;
+    const int maxDirections = 1024;
+
+    auto cdf = [] (double z) { return 0.5 * std::erfc(-z / std::sqrt(2.0)); };
+
+    const double du = 2 * range / nBins;
+    for (int k = 0; k < nBins; k++)
+    {
+        const double z = -range + k * du;
+        const double r = exp(mu + sigma * (z + du));
+
+        if (r < near + 0.5)
+        {
+            continue;
+        }
+
+        const int nDirections = min(maxDirections, max(64, int(ceil(8 * Pi * r))));
+        const double wd = (cdf(z + du) - cdf(z)) / nDirections;
+
+        // the directions of successive bins are rotated against each other (golden ratio) and
+        // every direction takes another distance within the bin, so that the rounding errors
+        // do not pile up on the same cells
+        const double shift = fmod(k * 0.6180339887498949, 1.0);
+
+        for (int j = 0; j < nDirections; j++)
+        {
+            const double direction = 2 * Pi * (j + shift) / nDirections;
+            const double r = exp(mu + sigma * (z + du * fmod((j + 0.5) * 0.7548776662466927, 1.0)));
+
+            long dx = lround(cos(direction) * r);
+            long dy = lround(sin(direction) * r);
+
+            if (labs(dx) > near || labs(dy) > near)
+            {
+                add(dx, dy, wd);
+            }
+        }
+    }
+
+    vector<int> order;
+    for (int c = 0; c < int(p.size()); c++)
+    {
+        if (p[c] > 0)
+        {
+            order.push_back(c);
+        }
+    }
+    stable_sort(order.begin(), order.end(), [&p] (int a, int b) { return p[a] > p[b]; });
+
+    // the truncated tails are spread proportionally
+    const double total = accumulate(p.begin(), p.end(), 0.0);
+
+    aTable.Prob.resize(order.size());
+    aTable.Cum.resize(order.size() + 1);
+    aTable.DX.resize(order.size());
+    aTable.DY.resize(order.size());
+
+    aTable.Cum[0] = 0;
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        aTable.Prob[i] = p[order[i]] / total;
+        aTable.Cum[i + 1] = aTable.Cum[i] + aTable.Prob[i];
+        aTable.DX[i] = order[i] / GridSize;
+        aTable.DY[i] = order[i] % GridSize;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Multinomial draw: the head of the table by a sequence of binomials (each offset receives a
+ * binomial share of the remaining seeds, with its probability relative to the remaining mass),
+ * the remaining seeds by inversion of the cumulative probabilities of the tail.
+ */
+void DispersalKernel::Disperse(int aPft, int aX, int aY, int aNSeeds, RandomGenerator & aRng,
+                               vector< pair<int, int> > & aTargets) const
+{
+    const Table & table = Tables[aPft];
+    const int size = table.Prob.size();
+
+    auto target = [this, &table, aX, aY] (int i)
+    {
+        int x = aX + table.DX[i];
+        int y = aY + table.DY[i];
+        if (x >= GridSize) x -= GridSize;
+        if (y >= GridSize) y -= GridSize;
+
+        return int(x * GridSize + y);
+    };
+
+    if (aNSeeds <= 0)
+    {
+        return;
+    }
+
+    // offsets with at least one expected seed
+    const int head = lower_bound(table.Prob.begin(), table.Prob.end(), 1.0 / aNSeeds, greater<double>()) - table.Prob.begin();
+
+    int left = aNSeeds;
+    double mass = 1.0;
+
+    int i = 0;
+    for (; i < head && left > 0; i++)
+    {
+        int n = (i + 1 == size || table.Prob[i] >= mass) ? left : aRng.getBinomial(left, table.Prob[i] / mass);
+
+        mass -= table.Prob[i];
+
+        if (n > 0)
+        {
+            aTargets.push_back(make_pair(target(i), n));
+            left -= n;
+        }
+    }
+
+    for (; left > 0; left--)
+    {
+        double u = table.Cum[i] + aRng.get01() * (table.Cum[size] - table.Cum[i]);
+
+        int k = upper_bound(table.Cum.begin() + i + 1, table.Cum.end(), u) - table.Cum.begin() - 1;
+        k = min(k, size - 1);
+
+        aTargets.push_back(make_pair(target(k), 1));
+    }
+}
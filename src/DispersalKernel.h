@@ -0,0 +1,46 @@
+#ifndef SRC_DISPERSALKERNEL_H_
+#define SRC_DISPERSALKERNEL_H_
+
+#include <vector>
+#include <utility>
+
+class TraitTable;
+class RandomGenerator;
+
+//! Seed dispersal of whole plants by a multinomial draw over a per-PFT table
+/*! The lognormal dispersal kernel of Grid::getTargetCell() is discretized once per PFT into
+ the probability of every cell offset on the torus. A plant's n seeds are then distributed
+ over the offsets that expect at least one of them (probability >= 1/n) by sequential binomial
+ draws, in the order of decreasing probability; the few seeds left for the sparse tail are
+ placed one by one. The cost is bounded by the support of the kernel instead of growing with
+ the number of seeds.
+ Only used without intraspecific trait variation, where all plants of a PFT share one kernel.
+ */
+class DispersalKernel
+{
+
+private:
+    struct Table
+    {
+        std::vector<double> Prob;   // decreasing
+        std::vector<double> Cum;    // Cum[i]: sum of Prob[0 .. i-1]
+        std::vector<int> DX;        // offset on the torus, 0 .. GridSize - 1
+        std::vector<int> DY;
+    };
+
+    long GridSize;
+    std::vector<Table> Tables;      // by Traits::PFT_nr
+
+    void buildTable(Table & aTable, const float mean, const float sd);
+
+public:
+    DispersalKernel();
+
+    void Init(long aGridSize, const TraitTable & aTraits);
+
+    // appends (cell index, number of seeds) for the seeds of one plant at (aX, aY)
+    void Disperse(int aPft, int aX, int aY, int aNSeeds, RandomGenerator & aRng,
+                  std::vector< std::pair<int, int> > & aTargets) const;
+};
+
+#endif
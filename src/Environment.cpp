@@ -39,14 +39,14 @@ void Environment::GetSim(string data)
 	// Read in simulation parameters
 
 	int IC_version;
-	int mode;
+	int mode_version;
 
 	std::stringstream ss(data);
 
 	ss	>> SimID 											// Simulation number
 		>> ComNr 											// Community number
 		>> IC_version 										// Stabilizing mechanisms
-		>> mode												// (0) Community assembly (normal), (1) invasion criterion, (2) catastrophic disturbance
+		>> mode_version										// (0) Community assembly (normal), (1) invasion criterion, (2) catastrophic disturbance
         >> ITVsd 						// Standard deviation of intraspecific variation
         >> Tmax 							// End of run year
         >> meanARes 						// Aboveground resources
@@ -86,7 +86,7 @@ void Environment::GetSim(string data)
 		break;
 	}
 
-	switch (mode)
+	switch (mode_version)
 	{
 	case 0:
         mode = communityAssembly;
@@ -141,25 +141,36 @@ void Environment::GetSim(string data)
     string srv;
     string trait;
     string aggregated;
+    string profile;
 
-    string param = 	dir + fid + "_param.csv";
+    // the tables that may be written as binary OutputTable chunks
+    const bool binary = (Parameters::format == binaryOutput);
+    const string table = binary ? ".bin" : ".csv";
+
+    // gzip compressed tables (--compress), Output::WriteRows tells them by the name
+    auto gz = [this] (outputTable aTable) { return (compressed & aTable) ? string(".gz") : string(); };
+
+    string param = 	dir + fid + "_param.csv" + gz(paramTable);
     if (trait_out) {
-        trait = 	dir + fid + "_trait.csv";
+        trait = 	dir + fid + "_trait.csv" + gz(traitTable);
     }
     if (srv_out) {
-        srv = 	dir + fid + "_srv.csv";
+        srv = 	dir + fid + "_srv" + table + gz(srvTable);
     }
     if (PFT_out) {
-        PFT = 	dir + fid + "_PFT.csv";
+        PFT = 	dir + fid + "_PFT" + table + gz(PFTTable);
     }
     if (ind_out) {
-        ind = 	dir + fid + "_ind.csv";
+        ind = 	dir + fid + "_ind" + table + gz(indTable);
     }
     if (aggregated_out) {
-        aggregated =   dir + fid + "_aggregated.csv";
+        aggregated =   dir + fid + "_aggregated" + table + gz(aggregatedTable);
+    }
+    if (Parameters::profile != noProfile) {
+        profile =   dir + fid + "_profile.csv" + gz(profileTable);
     }
 
-    output.setupOutput(param, trait, srv, PFT, ind, aggregated);
+    output.setupOutput(param, trait, srv, PFT, ind, aggregated, profile, binary);
 
 
     traits.ReadPFTDef(Parameters::NamePftFile);
@@ -167,12 +178,17 @@ void Environment::GetSim(string data)
 }
 
 std::string Environment::getSimID()
+{
+    return getSimID(RunNr);
+}
+
+std::string Environment::getSimID(int aRunNr)
 {
 
     std::string s =
             std::to_string(SimID) + "_" +
             std::to_string(ComNr) + "_" +
-            std::to_string(RunNr);
+            std::to_string(aRunNr);
 
     return s;
 }
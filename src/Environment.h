@@ -10,9 +10,11 @@
 
 #include "Parameters.h"
 #include "RandomGenerator.h"
+#include "Output.h"
 //
 //  This class should hold all data that are specific to the environment that is
-//  simulated.
+//  simulated. This includes the random number stream and the output buffers of the run,
+//  so several simulations can run side by side in one process.
 class Environment : public Parameters
 {
 
@@ -41,7 +43,11 @@ public:
 	    return std::fabs(a - b) < std::numeric_limits<double>::epsilon();
 	}
     std::string getSimID(); // Merge ID for data sets
-    Traits traits;
+    std::string getSimID(int aRunNr); // the ID of another repetition of this line
+    TraitTable traits;
+
+    RandomGenerator rng;    // random number stream of this run
+    Output output;          // output rows of this run
 };
 
 #endif
@@ -3,8 +3,6 @@
 #include "itv_mode.h"
 #include "Genet.h"
 
-int Genet::staticID = 0;
-
 /*
  * If the ramet has enough resources to fulfill its minimum requirements,
  * it will "donate" the rest of its resources to a pool that is then equally
@@ -22,13 +20,13 @@ void Genet::ResshareA()
 		auto ramet = ramet_ptr.lock();
 
 		double AddtoSum = 0;
-		double minres = ramet->traits->mThres * ramet->Ash_disc * ramet->traits->Gmax * 2;
+		double minres = ramet->traits->mThres * ramet->Ash_disc() * ramet->traits->Gmax * 2;
 
-		AddtoSum = std::max(0.0, ramet->Auptake - minres);
+		AddtoSum = std::max(0.0, ramet->Auptake() - minres);
 
 		if (AddtoSum > 0)
 		{
-			ramet->Auptake = minres;
+			ramet->Auptake() = minres;
 			sumAuptake += AddtoSum;
 		}
 	}
@@ -39,7 +37,7 @@ void Genet::ResshareA()
 		auto ramet = ramet_ptr.lock();
 		assert(ramet);
 
-		ramet->Auptake += MeanAuptake;
+		ramet->Auptake() += MeanAuptake;
 	}
 }
 
@@ -59,13 +57,13 @@ void Genet::ResshareB()
 		assert(ramet);
 
 		double AddtoSum = 0;
-		double minres = ramet->traits->mThres * ramet->Art_disc * ramet->traits->Gmax * 2;
+		double minres = ramet->traits->mThres * ramet->Art_disc() * ramet->traits->Gmax * 2;
 
-		AddtoSum = std::max(0.0, ramet->Buptake - minres);
+		AddtoSum = std::max(0.0, ramet->Buptake() - minres);
 
 		if (AddtoSum > 0)
 		{
-			ramet->Buptake = minres;
+			ramet->Buptake() = minres;
 			sumBuptake += AddtoSum;
 		}
 	}
@@ -76,6 +74,6 @@ void Genet::ResshareB()
 	{
 		auto ramet = ramet_ptr.lock();
 
-		ramet->Buptake += MeanBuptake;
+		ramet->Buptake() += MeanBuptake;
 	}
 }
@@ -16,11 +16,11 @@ class Genet
 {
 
 public:
-   static int staticID;
    int genetID;
    std::vector< std::weak_ptr<Plant> > RametList;
+   int NLiving;     // living ramets (kept by the PlantStore)
 
-   Genet():genetID(++staticID) { }
+   Genet(int aGenetID):genetID(aGenetID), NLiving(0) { }
 
    void ResshareA();     // share above-ground resources
    void ResshareB();     // share below-ground resources
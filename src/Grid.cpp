@@ -9,13 +9,13 @@
 #include "Environment.h"
 #include "RandomGenerator.h"
 #include "Output.h"
-#include "IBC-grass.h"
+#include "Checkpoint.h"
 
 using namespace std;
 
 //---------------------------------------------------------------------------
 
-Grid::Grid()
+Grid::Grid() : LastPlantID(0), LastGenetID(0), CellList(0)
 {
 
 }
@@ -24,17 +24,17 @@ Grid::Grid()
 
 Grid::~Grid()
 {
-    for (int i = 0; i < getGridArea(); ++i)
+    if (CellList != 0)
     {
-        Cell* cell = CellList[i];
-        delete cell;
+        for (int i = 0; i < getGridArea(); ++i)
+        {
+            Cell* cell = CellList[i];
+            delete cell;
+        }
+        delete[] CellList;
     }
-    delete[] CellList;
 
     ZOIBase.clear();
-
-    Plant::staticID = 0;
-    Genet::staticID = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -67,6 +67,8 @@ void Grid::CellsInit()
                     cerr << "Invalid stabilization mode. Exiting\n";
                     exit(0);
                 }
+            } else {
+                cell = new CellCompetition(x, y, AboveCompMode, BelowCompMode, stabilization);
             }
 
             if (cell != 0) {
@@ -85,22 +87,39 @@ void Grid::CellsInit()
         ZOIBase[i] = i;
     }
 
-    sort(ZOIBase.begin(), ZOIBase.end(), CompareIndexRel);
+    // compare two index-values in their distance to the center of grid
+    const int n = GridSize;
+    sort(ZOIBase.begin(), ZOIBase.end(),
+            [n] (const int i1, const int i2)
+            {
+                return Distance(i1 / n, i1 % n, n / 2, n / 2) < Distance(i2 / n, i2 % n, n / 2, n / 2);
+            });
+
+    if (coverage == csrCoverage)
+    {
+        Coverage.Init(GridSize, ZOIBase, traits.pftTraitTemplates.size());
+    }
+
+    if (ITV == off)
+    {
+        Dispersal.Init(GridSize, traits);
+    }
 }
 
 //-----------------------------------------------------------------------------
 
 void Grid::PlantLoop()
 {
+    // growth depends only on the plant's own state, so all living plants grow at once
+    Population.Grow(week);
+
     for (auto const& p : PlantList)
     {
         if (ITV == on)
             assert(p->traits->myTraitType == Traits::individualized);
 
-        if (!p->isDead)
+        if (!p->isDead())
         {
-            p->Grow(week);
-
             if (p->traits->clonal)
             {
                 DisperseRamets(p);
@@ -113,7 +132,7 @@ void Grid::PlantLoop()
                 DisperseSeeds(p);
             }
 
-            p->Kill(backgroundMortality);
+            p->Kill(backgroundMortality, rng);
         }
         else
         {
@@ -128,7 +147,7 @@ void Grid::PlantLoop()
  Each Seed is dispersed after an log-normal dispersal kernel with mean and sd
  given by plant traits. The dispersal direction has no prevalence.
  */
-void getTargetCell(int& xx, int& yy, const float mean, const float sd)
+void Grid::getTargetCell(int& xx, int& yy, const float mean, const float sd)
 {
     double sigma = std::sqrt(std::log((sd / mean) * (sd / mean) + 1));
     double mu = std::log(mean) - 0.5 * sigma;
@@ -151,6 +170,24 @@ void Grid::DisperseSeeds(const std::shared_ptr<Plant> & plant)
     int py = plant->getCell()->y;
     int n = plant->ConvertReproMassToSeeds();
 
+    Profile.Count(Profiler::SeedsDispersed, n);
+
+    if (ITV == off)
+    {
+        // all seeds of the plant at once, with the kernel table of its PFT
+        const Traits* t = plant->traits.get();
+
+        DispersalTargets.clear();
+        Dispersal.Disperse(t->PFT_nr, px, py, n, rng, DispersalTargets);
+
+        for (auto const& target : DispersalTargets)
+        {
+            CellList[target.first]->AddSeeds(t->PFT_nr, t->pEstab, t->seedMass, target.second);
+        }
+        Population.Stats.NSeeds += n;
+        return;
+    }
+
     for (int i = 0; i < n; ++i)
     {
         int x = px; // remember parent's position
@@ -165,8 +202,9 @@ void Grid::DisperseSeeds(const std::shared_ptr<Plant> & plant)
 
         Cell* cell = CellList[x * GridSize + y];
 
-        cell->SeedBankList.push_back(make_unique<Seed>(traits.createTraitSetFromPftType(plant->traits->PFT_ID), cell, ITV, ITVsd));
+        cell->SeedBankList.push_back(make_unique<Seed>(traits.getTraitSet(plant->traits->PFT_nr), cell, ITV, ITVsd, rng));
     }
+    Population.Stats.NSeeds += n;
 }
 
 //---------------------------------------------------------------------------
@@ -188,7 +226,7 @@ void Grid::DisperseRamets(const std::shared_ptr<Plant> & p)
         Torus(x, y);
 
         // save distance and direction in the plant
-        std::shared_ptr<Plant> Spacer = make_shared<Plant>(x, y, p, ITV);
+        std::shared_ptr<Plant> Spacer = make_shared<Plant>(x, y, p, ITV, ++LastPlantID);
         Spacer->spacerLengthToGrow = distance; // This spacer now has to grow to get to its new cell
         p->growingSpacerList.push_back(Spacer);
     }
@@ -202,13 +240,21 @@ void Grid::DisperseRamets(const std::shared_ptr<Plant> & p)
  */
 void Grid::CoverCells()
 {
+    Population.UpdateGeometry();
+
+    if (coverage == csrCoverage)
+    {
+        Coverage.Build(PlantList);
+        return;
+    }
+
     for (auto const& plant : PlantList)
     {
         double Ashoot = plant->Area_shoot();
-        plant->Ash_disc = floor(Ashoot) + 1;
+        plant->Ash_disc() = floor(Ashoot) + 1;
 
         double Aroot = plant->Area_root();
-        plant->Art_disc = floor(Aroot) + 1;
+        plant->Art_disc() = floor(Aroot) + 1;
 
         double Amax = max(Ashoot, Aroot);
 
@@ -237,7 +283,7 @@ void Grid::CoverCells()
             if (a < Aroot)
             {
                 // dead plants do not compete for below ground resource
-                if (!plant->isDead)
+                if (!plant->isDead())
                 {
                     cell->BelowPlantList.push_back(plant);
                     cell->PftNIndB[plant->pft()]++;
@@ -272,12 +318,19 @@ void Grid::ResetWeeklyVariables()
  */
 void Grid::DistributeResource()
 {
-    for (int i = 0; i < getGridArea(); ++i)
+    if (coverage == csrCoverage)
     {
-        Cell* cell = CellList[i];
+        Coverage.DistributeResource(CellList, Population, AboveCompMode, BelowCompMode, stabilization);
+    }
+    else
+    {
+        for (int i = 0; i < getGridArea(); ++i)
+        {
+            Cell* cell = CellList[i];
 
-        cell->AboveComp();
-        cell->BelowComp();
+            cell->AboveComp();
+            cell->BelowComp();
+        }
     }
 
     shareResources();
@@ -321,7 +374,7 @@ void Grid::EstablishmentLottery()
     {
         auto const& plant = PlantList[i];
 
-        if (plant->traits->clonal && !plant->isDead)
+        if (plant->traits->clonal && !plant->isDead())
         {
             establishRamets(plant);
         }
@@ -338,12 +391,18 @@ void Grid::EstablishmentLottery()
     {
         Cell* cell = CellList[i];
 
-        if (!cell->AbovePlantList.empty() || cell->SeedBankList.empty() || cell->occupied)
+        bool covered = (coverage == csrCoverage) ? Coverage.NAbove(i) > 0 : !cell->AbovePlantList.empty();
+
+        if (covered || !cell->hasSeeds() || cell->occupied)
         {
             continue;
         }
 
-        double sumSeedMass = cell->Germinate();
+        double sumSeedMass = cell->Germinate(rng);
+
+        int nGerminated = cell->GetNSeedlings();
+        Population.Stats.NSeeds -= nGerminated;
+        Profile.Count(Profiler::SeedsGerminated, nGerminated);
 
         if ( Environment::AreSame(sumSeedMass, 0) ) // No seeds germinated
         {
@@ -351,16 +410,32 @@ void Grid::EstablishmentLottery()
         }
 
         double n = rng.get01() * sumSeedMass;
-        for (auto const& itr : cell->SeedlingList)
+        if (ITV == on)
         {
-            n -= itr->mass;
-            if (n <= 0)
+            for (auto const& itr : cell->SeedlingList)
             {
-                establishSeedlings(itr);
-                break;
+                n -= itr->mass;
+                if (n <= 0)
+                {
+                    establishSeedlings(itr);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            for (auto const& cohort : cell->SeedlingCohortList)
+            {
+                n -= cohort.count * cohort.mass;
+                if (n <= 0)
+                {
+                    establishSeedlings(make_unique<Seed>(traits.getTraitSet(cohort.pft), cell, cohort.pEstab, ITV, ITVsd, rng));
+                    break;
+                }
             }
         }
         cell->SeedlingList.clear();
+        cell->SeedlingCohortList.clear();
     }
 }
 
@@ -368,15 +443,25 @@ void Grid::EstablishmentLottery()
 
 void Grid::establishSeedlings(const std::unique_ptr<Seed> & seed)
 {
-    shared_ptr<Plant> p = make_shared<Plant>(seed, ITV);
+    shared_ptr<Plant> p = make_shared<Plant>(seed, ITV, ++LastPlantID);
 
-    shared_ptr<Genet> genet = make_shared<Genet>();
+    shared_ptr<Genet> genet = make_shared<Genet>(++LastGenetID);
     GenetList.push_back(genet);
 
     genet->RametList.push_back(p);
     p->setGenet(genet);
 
-    PlantList.push_back(p);
+    addPlant(p);
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * The plant joins the population: its state is appended to the PlantStore.
+ */
+void Grid::addPlant(const std::shared_ptr<Plant> & plant)
+{
+    Population.Add(plant.get());
+    PlantList.push_back(plant);
 }
 
 //-----------------------------------------------------------------------------
@@ -407,7 +492,7 @@ void Grid::establishRamets(const std::shared_ptr<Plant> plant)
 
                 Genet->RametList.push_back(spacer);
                 spacer->setCell(cell);
-                PlantList.push_back(spacer);
+                addPlant(spacer);
             }
 
             // Regardless of establishment success, the iterator is removed from growingSpacerList
@@ -453,6 +538,7 @@ void Grid::SeedMortalityAge()
     for (int i = 0; i < getGridArea(); ++i)
     {
         Cell* cell = CellList[i];
+        int before = cell->GetNSeeds();
 
         for (auto const& seed : cell->SeedBankList)
         {
@@ -461,7 +547,16 @@ void Grid::SeedMortalityAge()
                 seed->toBeRemoved = true;
             }
         }
+        for (auto & cohort : cell->SeedCohortList)
+        {
+            if (cohort.age >= traits.getTraitSet(cohort.pft)->dormancy)
+            {
+                cohort.count = 0;
+            }
+        }
         cell->RemoveSeeds();
+
+        Population.Stats.NSeeds -= before - cell->GetNSeeds();
     }
 }
 
@@ -504,14 +599,14 @@ void Grid::Disturb()
 
 void Grid::RunCatastrophicDisturbance()
 {
-    for (auto const& p : PlantList)
+    for (int i = 0; i < Population.size(); i++)
     {
-        if (p->isDead)
+        if (Population.isDead[i])
             continue;
 
         if (rng.get01() < CatastrophicPlantMortality)
         {
-            p->isDead = true;
+            Population.Kill(i);
         }
     }
 
@@ -533,37 +628,105 @@ void Grid::GrazingAbvGr()
     double TotalAboveMass = GetTotalAboveMass();
 
     double MaxMassRemove = min(TotalAboveMass - ResidualMass, TotalAboveMass * AbvPropRemoved);
+
+    if (grazing == roundsGrazing)
+    {
+        grazeRounds(MaxMassRemove);
+    }
+    else
+    {
+        grazeWeighted(MaxMassRemove);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Single bites, each from a plant drawn with probability proportional to its
+ * palatability. The palatability of the bitten plant is updated after each bite;
+ * plants whose next bite would remove nothing (shoot and seed mass <= 1 mg) and
+ * dead plants have weight 0. The PlantList keeps its order.
+ */
+void Grid::grazeWeighted(double aMaxMassRemove)
+{
     double MassRemoved = 0;
 
-    while (MassRemoved < MaxMassRemove)
+    const vector<double> & mShoot = Population.mShoot;
+    const vector<double> & mRepro = Population.mRepro;
+    const vector<double> & GrazFraction = Population.GrazFraction;
+    const vector<char> & isDead = Population.isDead;
+
+    auto palatability = [&] (int i)
     {
-        auto p = *std::max_element(PlantList.begin(), PlantList.end(),
-                        [](const shared_ptr<Plant> & a, const shared_ptr<Plant> & b)
-                        {
-                            return Plant::getPalatability(a) < Plant::getPalatability(b);
-                        });
+        if (isDead[i] || mShoot[i] + mRepro[i] <= 1)
+        {
+            return 0.0;
+        }
+        return mShoot[i] * GrazFraction[i];
+    };
+
+    GrazingWeights.resize(Population.size());
+    for (int i = 0; i < Population.size(); i++)
+    {
+        GrazingWeights[i] = palatability(i);
+    }
+    GrazingSampler.Build(GrazingWeights);
+
+    // nothing left to graze: stop, even if the mass to remove is not reached
+    while (MassRemoved < aMaxMassRemove && !GrazingSampler.Empty())
+    {
+        int i = GrazingSampler.Draw(rng.get01());
+
+        MassRemoved += Population.owner[i]->RemoveShootMass(BiteSize);
+
+        GrazingSampler.Set(i, palatability(i));
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * The original algorithm: in rounds over the shuffled PlantList, each plant is bitten
+ * with probability of its palatability relative to the most palatable plant.
+ */
+void Grid::grazeRounds(double aMaxMassRemove)
+{
+    double MassRemoved = 0;
+
+    const vector<double> & mShoot = Population.mShoot;
+    const vector<double> & GrazFraction = Population.GrazFraction;
+    const vector<char> & isDead = Population.isDead;
 
-        double max_palatability = Plant::getPalatability(p);
+    while (MassRemoved < aMaxMassRemove)
+    {
+        // palatability of dead plants is 0
+        double max_palatability = 0;
+        for (int i = 0; i < Population.size(); i++)
+        {
+            if (!isDead[i])
+            {
+                max_palatability = max(max_palatability, mShoot[i] * GrazFraction[i]);
+            }
+        }
 
-        std::shuffle( PlantList.begin(), PlantList.end(), rng.getRNG() );
+        rng.shuffle( PlantList.begin(), PlantList.end() );
+        Population.Reorder(PlantList);
 
-        for (auto const& plant : PlantList)
+        for (int i = 0; i < Population.size(); i++)
         {
-            if (MassRemoved >= MaxMassRemove)
+            if (MassRemoved >= aMaxMassRemove)
             {
                 break;
             }
 
-            if (plant->isDead)
+            if (isDead[i])
             {
                 continue;
             }
 
-            double grazProb = Plant::getPalatability(plant) / max_palatability;
+            double grazProb = (mShoot[i] * GrazFraction[i]) / max_palatability;
 
             if (rng.get01() < grazProb)
             {
-                MassRemoved += plant->RemoveShootMass(BiteSize);
+                MassRemoved += Population.owner[i]->RemoveShootMass(BiteSize);
             }
         }
     }
@@ -575,14 +738,16 @@ void Grid::GrazingAbvGr()
  */
 void Grid::Cutting(double cut_height)
 {
+    Population.UpdateGeometry();
+
     for (auto const& i : PlantList)
     {
         if (i->getHeight() > cut_height)
         {
             double biomass_at_height = i->getBiomassAtHeight(cut_height);
 
-            i->mShoot = biomass_at_height;
-            i->mRepro = 0.0;
+            i->mShoot() = biomass_at_height;
+            i->mRepro() = 0.0;
         }
     }
 }
@@ -593,31 +758,24 @@ void Grid::GrazingBelGr()
 {
     assert(!Grid::below_biomass_history.empty());
 
-    // Total living root biomass
-    double bt = accumulate(PlantList.begin(), PlantList.end(), 0,
-                    [] (double s, const shared_ptr<Plant>& p)
-                    {
-                        if ( !p->isDead )
-                        {
-                            s = s + p->mRoot;
-                        }
-                        return s;
-                    });
+    vector<double> & mRoot = Population.mRoot;
+    const vector<char> & isDead = Population.isDead;
 
-    const double alpha = BelGrazAlpha;
-
-    std::vector<double> rolling_mean;
-    vector<double>::size_type historySize = BelGrazHistorySize; // in Weeks
-    if (Grid::below_biomass_history.size() > historySize)
+    // Total living root biomass (an int sum, as std::accumulate with the init value 0 computes it)
+    int bt_sum = 0;
+    for (int i = 0; i < Population.size(); i++)
     {
-        rolling_mean = std::vector<double>(Grid::below_biomass_history.end() - historySize, Grid::below_biomass_history.end());
-    }
-    else
-    {
-        rolling_mean = std::vector<double>(Grid::below_biomass_history.begin(), Grid::below_biomass_history.end());
+        if (!isDead[i])
+        {
+            bt_sum = bt_sum + mRoot[i];
+        }
     }
+    double bt = bt_sum;
 
-    double fn_o = BelGrazPerc * ( accumulate(rolling_mean.begin(), rolling_mean.end(), 0) / rolling_mean.size() );
+    const double alpha = BelGrazAlpha;
+
+    // mean of the last BelGrazHistorySize weeks (an integer division, as before)
+    double fn_o = BelGrazPerc * ( below_biomass_history.sum() / below_biomass_history.size() );
 
     // Functional response
     if (bt - fn_o < bt * BelGrazResidualPerc)
@@ -628,44 +786,61 @@ void Grid::GrazingBelGr()
     output.BlwgrdGrazingPressure.push_back(fn_o);
     output.ContemporaneousRootmassHistory.push_back(bt);
 
+    // the living plants; the ones eaten to death drop out after each iteration
+    vector<int> & living = GrazingLiving;
+    vector<double> & weight = GrazingWeights;
+
+    living.clear();
+    for (int i = 0; i < Population.size(); i++)
+    {
+        if (!isDead[i])
+        {
+            living.push_back(i);
+        }
+    }
+    weight.resize(living.size());
+
     double fn = fn_o;
     double t_br = 0; // total biomass removed
-    while (ceil(t_br) < fn_o)
+    while (ceil(t_br) < fn_o && !living.empty())
     {
+        // the weight of each plant once per iteration
         double bite = 0;
-        for (auto const& p : PlantList)
+        for (size_t k = 0; k < living.size(); k++)
         {
-            if (!p->isDead)
-            {
-                bite += pow(p->mRoot / bt, alpha) * fn;
-            }
+            weight[k] = pow(mRoot[living[k]] / bt, alpha);
+            bite += weight[k] * fn;
         }
         bite = fn / bite;
 
         double br = 0; // Biomass removed this iteration
         double leftovers = 0; // When a plant is eaten to death, this is the overshoot from the algorithm
-        for (auto const& p : PlantList)
+        size_t n = 0;
+        for (size_t k = 0; k < living.size(); k++)
         {
-            if (p->isDead)
-            {
-                continue;
-            }
+            const int i = living[k];
 
-            double biomass_to_remove = pow(p->mRoot / bt, alpha) * fn * bite;
+            double biomass_to_remove = weight[k] * fn * bite;
 
-            if (biomass_to_remove >= p->mRoot)
+            if (biomass_to_remove >= mRoot[i])
             {
-                leftovers = leftovers + (biomass_to_remove - p->mRoot);
-                br = br + p->mRoot;
-                p->mRoot = 0;
-                p->isDead = true;
+                leftovers = leftovers + (biomass_to_remove - mRoot[i]);
+                br = br + mRoot[i];
+                mRoot[i] = 0;
+                Population.Kill(i);
             }
             else
             {
-                p->RemoveRootMass(biomass_to_remove);
+                Population.owner[i]->RemoveRootMass(biomass_to_remove);
                 br = br + biomass_to_remove;
             }
+
+            if (!isDead[i])
+            {
+                living[n++] = i;
+            }
         }
+        living.resize(n);
 
         t_br = t_br + br;
         bt = bt - br;
@@ -679,6 +854,8 @@ void Grid::GrazingBelGr()
 
 void Grid::RemovePlants()
 {
+    Population.Compact();
+
     // Delete the CPlant shared_pointers
     PlantList.erase(
             std::remove_if(PlantList.begin(), PlantList.end(),
@@ -729,6 +906,10 @@ void Grid::RemovePlants()
 
 void Grid::Winter()
 {
+    assert(Population.Stats.NPlants == Population.NPlants());
+    assert(Population.Stats.NGenets == CountNclonalPlants());
+    assert(Population.Stats.NSeeds == CountNSeeds());
+
     RemovePlants();
     for (auto const& p : PlantList)
     {
@@ -743,9 +924,12 @@ void Grid::SeedMortalityWinter()
     for (int i = 0; i < getGridArea(); ++i)
     {
         Cell* cell = CellList[i];
+        int before = cell->GetNSeeds();
+
+        const double* u = rng.get01Batch(cell->SeedBankList.size());
         for (auto const& seed : cell->SeedBankList)
         {
-            if (rng.get01() < seedMortality)
+            if (*u++ < seedMortality)
             {
                 seed->toBeRemoved = true;
             }
@@ -754,8 +938,15 @@ void Grid::SeedMortalityWinter()
                 ++seed->age;
             }
         }
+        for (auto & cohort : cell->SeedCohortList)
+        {
+            cohort.count -= rng.getBinomial(cohort.count, seedMortality);
+            ++cohort.age;
+        }
 
         cell->RemoveSeeds();
+
+        Population.Stats.NSeeds -= before - cell->GetNSeeds();
     }
 }
 
@@ -772,8 +963,17 @@ void Grid::InitSeeds(string PFT_ID, const int n, const double estab)
 
         Cell* cell = CellList[x * GridSize + y];
 
-        cell->SeedBankList.push_back(make_unique<Seed>(traits.createTraitSetFromPftType(PFT_ID), cell, estab, ITV, ITVsd));
+        if (ITV == on)
+        {
+            cell->SeedBankList.push_back(make_unique<Seed>(traits.getTraitSet(PFT_ID), cell, estab, ITV, ITVsd, rng));
+        }
+        else
+        {
+            auto const& t = traits.getTraitSet(PFT_ID);
+            cell->AddSeeds(t->PFT_nr, estab, t->seedMass, 1);
+        }
     }
+    Population.Stats.NSeeds += n;
 }
 
 //---------------------------------------------------------------------------
@@ -810,20 +1010,11 @@ double Distance(const double xx, const double yy, const double x, const double y
     return sqrt((xx - x) * (xx - x) + (yy - y) * (yy - y));
 }
 
-//-----------------------------------------------------------------------------
-
-bool CompareIndexRel(const int i1, const int i2)
-{
-    const int n = GridSize;
-
-    return Distance(i1 / n, i1 % n, n / 2, n / 2) < Distance(i2 / n, i2 % n, n / 2, n / 2);
-}
-
 //---------------------------------------------------------------------------
 /*
  * Accounts for the gridspace being torus
  */
-void Torus(int& xx, int& yy)
+void Grid::Torus(int& xx, int& yy) const
 {
     xx %= GridSize;
     if (xx < 0)
@@ -842,34 +1033,14 @@ void Torus(int& xx, int& yy)
 
 double Grid::GetTotalAboveMass()
 {
-    double above_mass = 0;
-    for (auto const& p : PlantList)
-    {
-        if (p->isDead)
-        {
-            continue;
-        }
-
-        above_mass += p->mShoot + p->mRepro;
-    }
-    return above_mass;
+    return Population.TotalAboveMass();
 }
 
 //---------------------------------------------------------------------------
 
 double Grid::GetTotalBelowMass()
 {
-    double below_mass = 0;
-    for (auto const& p : PlantList)
-    {
-        if (p->isDead)
-        {
-            continue;
-        }
-
-        below_mass += p->mRoot;
-    }
-    return below_mass;
+    return Population.TotalBelowMass();
 }
 
 double Grid::GetTotalAboveComp()
@@ -899,6 +1070,29 @@ double Grid::GetTotalBelowComp()
 //-----------------------------------------------------------------------------
 
 int Grid::GetNclonalPlants()
+{
+    return Population.Stats.NGenets;
+}
+
+//-----------------------------------------------------------------------------
+
+int Grid::GetNPlants() //count non-clonal plants
+{
+    return Population.Stats.NPlants;
+}
+
+//-----------------------------------------------------------------------------
+
+int Grid::GetNSeeds()
+{
+    return Population.Stats.NSeeds;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * The counts of the statistics, by scanning the genets and cells (consistency check).
+ */
+int Grid::CountNclonalPlants()
 {
     int NClonalPlants = 0;
     for (auto const& g : GenetList)
@@ -908,7 +1102,7 @@ int Grid::GetNclonalPlants()
         for (auto const& r_ptr : g->RametList)
         {
             auto const& r = r_ptr.lock();
-            if (!r->isDead)
+            if (!r->isDead())
             {
                 hasLivingRamet = true;
                 break;
@@ -925,31 +1119,294 @@ int Grid::GetNclonalPlants()
 
 //-----------------------------------------------------------------------------
 
-int Grid::GetNPlants() //count non-clonal plants
+int Grid::CountNSeeds()
 {
-    int NPlants = 0;
+    int seedCount = 0;
+    for (int i = 0; i < getGridArea(); ++i)
+    {
+        Cell* cell = CellList[i];
+        seedCount = seedCount + cell->GetNSeeds();
+    }
+
+    return seedCount;
+}
+
+//-----------------------------------------------------------------------------
+
+long Grid::GetNCoveredEntries()
+{
+    if (coverage == csrCoverage)
+    {
+        return Coverage.NEntries();
+    }
+
+    long n = 0;
+    for (int i = 0; i < getGridArea(); ++i)
+    {
+        n += CellList[i]->AbovePlantList.size() + CellList[i]->BelowPlantList.size();
+    }
+    return n;
+}
+//-----------------------------------------------------------------------------
+/**
+ * The state of the grid between two weeks: the cells with their seed banks, the genets,
+ * the plants with their growing spacers and the PlantStore. The coverage, the dispersal
+ * tables and the covered cells of the plants follow from it and are rebuilt when needed.
+ *
+ * Trait sets of a species are referenced by the PFT number. The individual trait sets of
+ * ITV are written where they are first referenced and shared again when they are read.
+ */
+void Grid::SaveState(CheckpointWriter & aWriter) const
+{
+    map<const Traits*, int32_t> individual;
+
+    auto writeTraits = [&] (const shared_ptr<const Traits> & t)
+    {
+        if (t->myTraitType == Traits::species)
+        {
+            aWriter.Write(int32_t(-1 - t->PFT_nr));
+            return;
+        }
+
+        auto pos = individual.find(t.get());
+        if (pos != individual.end())
+        {
+            aWriter.Write(pos->second);
+            return;
+        }
+
+        int32_t ref = individual.size();
+        individual[t.get()] = ref;
+        aWriter.Write(ref);
+        t->SaveState(aWriter);
+    };
+
+    auto writePlant = [&] (const shared_ptr<Plant> & p)
+    {
+        auto genet = p->genet.lock();
+
+        writeTraits(p->traits);
+        aWriter.Write(p->plantID);
+        aWriter.Write(genet ? genet->genetID : -1);
+        aWriter.Write(p->x);
+        aWriter.Write(p->y);
+        aWriter.Write(p->age);
+        aWriter.Write(p->lifetimeFecundity);
+        aWriter.Write(p->toBeRemoved);
+        aWriter.Write(p->spacerLengthToGrow);
+    };
+
+    aWriter.Write(uint64_t(traits.pftByNr.size()));
+    for (auto const& t : traits.pftByNr)
+    {
+        aWriter.Write(t->PFT_ID);
+    }
+
+    aWriter.Write(LastPlantID);
+    aWriter.Write(LastGenetID);
+    below_biomass_history.SaveState(aWriter);
+    Profile.SaveState(aWriter);
+
+    for (int i = 0; i < getGridArea(); ++i)
+    {
+        const Cell* cell = CellList[i];
+
+        assert(cell->SeedlingList.empty() && cell->SeedlingCohortList.empty());
+
+        aWriter.Write(cell->AResConc);
+        aWriter.Write(cell->BResConc);
+        aWriter.Write(cell->aComp_weekly);
+        aWriter.Write(cell->bComp_weekly);
+        aWriter.Write(cell->occupied);
+
+        aWriter.Write(uint64_t(cell->SeedBankList.size()));
+        for (auto const& seed : cell->SeedBankList)
+        {
+            writeTraits(seed->traits);
+            aWriter.Write(seed->mass);
+            aWriter.Write(seed->pEstab);
+            aWriter.Write(seed->age);
+            aWriter.Write(seed->toBeRemoved);
+        }
+
+        aWriter.Write(uint64_t(cell->SeedCohortList.size()));
+        for (auto const& cohort : cell->SeedCohortList)
+        {
+            aWriter.Write(cohort.pft);
+            aWriter.Write(cohort.pEstab);
+            aWriter.Write(cohort.mass);
+            aWriter.Write(cohort.age);
+            aWriter.Write(cohort.count);
+        }
+    }
+
+    aWriter.Write(uint64_t(GenetList.size()));
+    for (auto const& g : GenetList)
+    {
+        aWriter.Write(g->genetID);
+        aWriter.Write(g->NLiving);
+    }
+
+    aWriter.Write(uint64_t(PlantList.size()));
     for (auto const& p : PlantList)
     {
-        //only if its a non-clonal plant
-        if (!p->traits->clonal && !p->isDead)
+        writePlant(p);
+
+        aWriter.Write(uint64_t(p->growingSpacerList.size()));
+        for (auto const& spacer : p->growingSpacerList)
+        {
+            writePlant(spacer);
+        }
+    }
+
+    // the ramets refer to the plants by their ID
+    for (auto const& g : GenetList)
+    {
+        aWriter.Write(uint64_t(g->RametList.size()));
+        for (auto const& r : g->RametList)
         {
-            NPlants++;
+            auto ramet = r.lock();
+            assert(ramet);
+            aWriter.Write(ramet->plantID);
         }
     }
-    return NPlants;
+
+    Population.SaveState(aWriter);
 }
 
 //-----------------------------------------------------------------------------
-
-int Grid::GetNSeeds()
+/**
+ * Restores the state written by SaveState into a grid that was set up by CellsInit
+ * with the same parameters.
+ */
+void Grid::LoadState(CheckpointReader & aReader)
 {
-    int seedCount = 0;
+    assert(CellList != 0 && PlantList.empty() && GenetList.empty());
+
+    vector< shared_ptr<const Traits> > individual;
+
+    auto readTraits = [&] () -> shared_ptr<const Traits>
+    {
+        int32_t ref = aReader.Read<int32_t>();
+
+        if (ref < 0)
+        {
+            return traits.getTraitSet(-1 - ref);
+        }
+
+        if (ref == int32_t(individual.size()))
+        {
+            auto t = make_shared<Traits>();
+            t->LoadState(aReader);
+            individual.push_back(t);
+        }
+        return individual.at(ref);
+    };
+
+    map< int, shared_ptr<Genet> > genets;
+    map< int, shared_ptr<Plant> > plants;
+
+    auto readPlant = [&] () -> shared_ptr<Plant>
+    {
+        auto t = readTraits();
+        auto p = make_shared<Plant>(t, aReader.Read<int>());
+
+        int genetID = aReader.Read<int>();
+        if (genetID >= 0)
+        {
+            p->setGenet(genets.at(genetID));
+        }
+
+        aReader.Read(p->x);
+        aReader.Read(p->y);
+        aReader.Read(p->age);
+        aReader.Read(p->lifetimeFecundity);
+        aReader.Read(p->toBeRemoved);
+        aReader.Read(p->spacerLengthToGrow);
+        return p;
+    };
+
+    vector<string> pfts(aReader.Read<uint64_t>());
+    for (auto & name : pfts)
+    {
+        aReader.Read(name);
+    }
+    if (pfts.size() != traits.pftByNr.size() ||
+            !std::equal(pfts.begin(), pfts.end(), traits.pftByNr.begin(),
+                    [] (const string & name, const shared_ptr<const Traits> & t) { return name == t->PFT_ID; }))
+    {
+        cerr << "The checkpoint was written with other PFTs. Exiting\n";
+        exit(1);
+    }
+
+    aReader.Read(LastPlantID);
+    aReader.Read(LastGenetID);
+    below_biomass_history.LoadState(aReader);
+    Profile.LoadState(aReader);
+
     for (int i = 0; i < getGridArea(); ++i)
     {
         Cell* cell = CellList[i];
-        seedCount = seedCount + int(cell->SeedBankList.size());
+
+        aReader.Read(cell->AResConc);
+        aReader.Read(cell->BResConc);
+        aReader.Read(cell->aComp_weekly);
+        aReader.Read(cell->bComp_weekly);
+        aReader.Read(cell->occupied);
+
+        cell->SeedBankList.resize(aReader.Read<uint64_t>());
+        for (auto & seed : cell->SeedBankList)
+        {
+            // without variation: the trait set is the one read
+            seed = make_unique<Seed>(readTraits(), cell, 0, off, 0, rng);
+            aReader.Read(seed->mass);
+            aReader.Read(seed->pEstab);
+            aReader.Read(seed->age);
+            aReader.Read(seed->toBeRemoved);
+        }
+
+        cell->SeedCohortList.resize(aReader.Read<uint64_t>());
+        for (auto & cohort : cell->SeedCohortList)
+        {
+            aReader.Read(cohort.pft);
+            aReader.Read(cohort.pEstab);
+            aReader.Read(cohort.mass);
+            aReader.Read(cohort.age);
+            aReader.Read(cohort.count);
+        }
     }
 
-    return seedCount;
+    GenetList.resize(aReader.Read<uint64_t>());
+    for (auto & g : GenetList)
+    {
+        g = make_shared<Genet>(aReader.Read<int>());
+        aReader.Read(g->NLiving);
+        genets[g->genetID] = g;
+    }
+
+    PlantList.resize(aReader.Read<uint64_t>());
+    for (auto & p : PlantList)
+    {
+        p = readPlant();
+        p->setCell(CellList[p->x * GridSize + p->y]);
+        plants[p->plantID] = p;
+
+        p->growingSpacerList.resize(aReader.Read<uint64_t>());
+        for (auto & spacer : p->growingSpacerList)
+        {
+            spacer = readPlant();
+        }
+    }
+
+    for (auto const& g : GenetList)
+    {
+        g->RametList.resize(aReader.Read<uint64_t>());
+        for (auto & r : g->RametList)
+        {
+            r = plants.at(aReader.Read<int>());
+        }
+    }
+
+    Population.LoadState(aReader, PlantList);
 }
 
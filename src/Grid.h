@@ -9,6 +9,14 @@
 #include "Cell.h"
 #include "Plant.h"
 #include "Environment.h"
+#include "ZOICoverage.h"
+#include "DispersalKernel.h"
+#include "Profiler.h"
+#include "WeightedSampler.h"
+#include "RingBuffer.h"
+
+class CheckpointWriter;
+class CheckpointReader;
 
 //! Class with all spatial algorithms where plant individuals interact in space
 /*! Functions for competition and plant growth are overwritten by inherited classes
@@ -19,10 +27,23 @@ class Grid : public Environment
 
 private:
     std::vector<int> ZOIBase;
+    ZOICoverage Coverage;                                   // ZOI of all plants as flat arrays (csrCoverage)
+    DispersalKernel Dispersal;                              // seed dispersal by PFT tables (ITV off)
+    std::vector< std::pair<int, int> > DispersalTargets;    // scratch: (cell, seeds) of one plant
     std::vector< std::shared_ptr<Genet> > GenetList;
+    int LastPlantID;                                        // ID counters of this run
+    int LastGenetID;
     void establishRamets(const std::shared_ptr<Plant> plant); 	// establish ramets
     void shareResources();                						// share resources among connected ramets
     void establishSeedlings(const std::unique_ptr<Seed> & seed);
+    void addPlant(const std::shared_ptr<Plant> & plant);     // appends an established plant to PlantList and Population
+    void grazeWeighted(double aMaxMassRemove);              // aboveground grazing by single weighted bites
+    void grazeRounds(double aMaxMassRemove);                // aboveground grazing by the original rounds
+    WeightedSampler GrazingSampler;                         // palatability of the plants while grazing
+    std::vector<double> GrazingWeights;                     // scratch: palatabilities, belowground weights
+    std::vector<int> GrazingLiving;                         // scratch: slots of the living plants
+    int CountNclonalPlants();                               // the counts of Population.Stats by full scans
+    int CountNSeeds();
 
 protected:
     void CoverCells();					// assigns grid cells to plants - which cell is covered by which plant
@@ -44,10 +65,16 @@ protected:
     void CellsInit();					// Creates the cells that make up the grid
     void SetCellResources();			// Populates the grid with resources (weekly)
 
+    void Torus(int& xx, int& yy) const;                                         // periodic boundary conditions (change by reference)
+    void getTargetCell(int& xx, int& yy, const float mean, const float sd);    // dispersal kernel for seeds (change by reference)
+    inline long getGridArea() const { return GridSize * GridSize; }
+
 public:
     Cell** CellList;    								// array of pointers to CCell
     std::vector< std::shared_ptr<Plant> > PlantList;    // plant individuals
-    std::vector<int> below_biomass_history;
+    PlantStore Population;                              // state of the plants in PlantList, slot i is PlantList[i]
+    RingBuffer<int, long> below_biomass_history;        // total living root mass of the last BelGrazHistorySize weeks
+    Profiler Profile;                                   // time and work of the weekly phases (--profile)
 
     Grid();
     ~Grid();
@@ -59,21 +86,16 @@ public:
 
     void InitSeeds(std::string PFT_ID, const int n, const double estab);
 
-    int GetNclonalPlants();   	// number of living clonal plants
+    int GetNclonalPlants();   	// number of living clonal plants (genets with a living ramet)
     int GetNPlants();         	// number of living non-clonal plants
-    int GetNSeeds();			// number of seeds
-};
+    int GetNSeeds();			// number of seeds in the seed banks
+    long GetNCoveredEntries();  // plant-cell pairs of all ZOIs, above- and belowground
 
-// periodic boundary conditions
-void Torus(int& xx, int& yy); // Change by reference
-
-// dispersal kernel for seeds
-void getTargetCell(int& xx, int& yy, const float mean, const float sd); // Change by reference
+    void SaveState(CheckpointWriter & aWriter) const;  // state of the cells, seeds and plants between two weeks
+    void LoadState(CheckpointReader & aReader);
+};
 
 // Euclidean distance between two points
 double Distance(const double xx, const double yy, const double x, const double y);
 
-// compare two index-values in their distance to the center of grid
-bool CompareIndexRel(const int a, const int b);
-
 #endif
@@ -9,12 +9,12 @@
 #include "Output.h"
 #include "Grid.h"
 #include "GridEnvir.h"
-#include "IBC-grass.h"
+#include "Checkpoint.h"
 using namespace std;
 
 //------------------------------------------------------------------------------
 
-GridEnvir::GridEnvir() { }
+GridEnvir::GridEnvir() : Resumed(false), Interrupted(false) { }
 
 //------------------------------------------------------------------------------
 /**
@@ -22,10 +22,70 @@ GridEnvir::GridEnvir() { }
  */
 void GridEnvir::InitRun()
 {
-    CellsInit();
+    setupRun();
     InitInds();
 }
 
+//------------------------------------------------------------------------------
+
+void GridEnvir::setupRun()
+{
+    Profile.Enabled = (profile != noProfile);
+    Profile.Reset();
+
+    below_biomass_history.SetCapacity(max(1, BelGrazHistorySize));
+
+    CellsInit();
+}
+
+//------------------------------------------------------------------------------
+/**
+ * The grid is set up from the parameters as for a new run, everything that
+ * changes during the run is read from the checkpoint.
+ */
+void GridEnvir::ResumeRun(CheckpointReader & aReader)
+{
+    setupRun();
+
+    aReader.Read(year);
+    aReader.Read(week);
+    aReader.Read(PftSurvTime);
+
+    rng.LoadState(aReader);
+    output.LoadState(aReader);
+    LoadState(aReader);
+
+    Resumed = true;
+}
+
+//------------------------------------------------------------------------------
+/**
+ * A snapshot of the burn-in (--shared-burnin) is continued with the random number
+ * stream of this run. The burn-in handed its rows to this run before.
+ */
+void GridEnvir::BranchRun(CheckpointReader & aReader)
+{
+    ResumeRun(aReader);
+
+    rng.seed(startSeed, SimID, ComNr, RunNr, generator);
+
+    // the param row holds the repetition number apart from the ID
+    print_param();
+}
+
+//------------------------------------------------------------------------------
+
+void GridEnvir::SaveRun(CheckpointWriter & aWriter, int aYear, int aWeek) const
+{
+    aWriter.Write(aYear);
+    aWriter.Write(aWeek);
+    aWriter.Write(PftSurvTime);
+
+    rng.SaveState(aWriter);
+    output.SaveState(aWriter);
+    SaveState(aWriter);
+}
+
 //-----------------------------------------------------------------------------
 
 void GridEnvir::InitInds()
@@ -56,11 +116,14 @@ void GridEnvir::InitInds()
 
 void GridEnvir::OneRun()
 {
-    print_param();
-
-    if (trait_out)
+    if (!Resumed)
     {
-        print_trait();
+        print_param();
+
+        if (trait_out)
+        {
+            print_trait();
+        }
     }
 
     do {
@@ -68,56 +131,124 @@ void GridEnvir::OneRun()
 
         OneYear();
 
-        if (mode == invasionCriterion && year == Tmax_monoculture)
+        if (Interrupted)
         {
-            const int no_init_seeds = 100;
-            const double estab = 1.0;
-
-            string invader = traits.pftInsertionOrder[0];
-            InitSeeds(invader, no_init_seeds, estab);
-            PftSurvTime[invader] = 0;
+            return;
         }
 
-        if (exitConditions())
+        // a monoculture that died out still gets its invader next year
+        if (exitConditions() && !(mode == invasionCriterion && year == Tmax_monoculture))
         {
             break;
         }
 
+        // every checkpointYears years, and when stopped at the end of the year
+        if (year < Tmax && (Checkpoint::StopRequested() || (checkpointYears > 0 && year % checkpointYears == 0)))
+        {
+            SaveCheckpoint(year + 1, 1);
+
+            if (Checkpoint::StopRequested())
+            {
+                Interrupted = true;
+                return;
+            }
+        }
+
+        week = 1;
     } while (++year <= Tmax);
 
+    if (profile != noProfile)
+    {
+        print_profile("total", Profile.RunRow());
+    }
 }
 
 //-----------------------------------------------------------------------------
 
 void GridEnvir::OneYear()
 {
-    week = 1;
-
+    // week is 1, unless the run was resumed within the year
     do {
         //std::cout << "y " << year << " w " << week << std::endl;
 
+        if (atBranchPoint())
+        {
+            Branch();
+        }
+
+        // the invader comes as seeds after the monoculture years
+        if (mode == invasionCriterion && year == Tmax_monoculture + 1 && week == 1)
+        {
+            const int no_init_seeds = 100;
+            const double estab = 1.0;
+
+            string invader = traits.pftInsertionOrder[0];
+            InitSeeds(invader, no_init_seeds, estab);
+            PftSurvTime[invader] = 0;
+        }
+
         OneWeek();
+        WriteOutput();
 
-        if (exitConditions()) break;
+        bool extinct;
+        {
+            Profiler::Scope scope(Profile, Profiler::Output);
+            extinct = exitConditions();
+        }
+        if (extinct) break;
+
+        // stopped within the year: the run continues with the next week
+        if (week < WeeksPerYear && Checkpoint::StopRequested())
+        {
+            SaveCheckpoint(year, week + 1);
+            Interrupted = true;
+            return;
+        }
 
     } while (++week <= WeeksPerYear);
+
+    if (profile == yearlyProfile)
+    {
+        print_profile(std::to_string(year), Profile.YearRow());
+    }
+    Profile.EndYear();
 }
 
 //-----------------------------------------------------------------------------
 
 void GridEnvir::OneWeek()
 {
+    Profile.Count(Profiler::Weeks, 1);
 
-    ResetWeeklyVariables(); // Clear ZOI data
-    SetCellResources();     // Restore/modulate cell resources
-
-    CoverCells();          	// Calculate zone of influences (ZOIs)
-    DistributeResource();   // Allot resources based on ZOI
-
-    PlantLoop();            // Growth, dispersal, mortality
+    {
+        Profiler::Scope scope(Profile, Profiler::ResetWeeklyVariables);
+        ResetWeeklyVariables(); // Clear ZOI data
+    }
+    {
+        Profiler::Scope scope(Profile, Profiler::SetCellResources);
+        SetCellResources();     // Restore/modulate cell resources
+    }
+    {
+        Profiler::Scope scope(Profile, Profiler::CoverCells);
+        CoverCells();          	// Calculate zone of influences (ZOIs)
+    }
+    if (Profile.Enabled)
+    {
+        Profile.Count(Profiler::Plants, PlantList.size());
+        Profile.Count(Profiler::CoveredEntries, GetNCoveredEntries());
+    }
+    {
+        Profiler::Scope scope(Profile, Profiler::DistributeResource);
+        DistributeResource();   // Allot resources based on ZOI
+    }
+    {
+        Profiler::Scope scope(Profile, Profiler::PlantLoop);
+        PlantLoop();            // Growth, dispersal, mortality
+    }
 
     if (year > 1)
     {
+        Profiler::Scope scope(Profile, Profiler::Disturb);
         Disturb();  		// Grazing and disturbances
     }
 
@@ -125,29 +256,41 @@ void GridEnvir::OneWeek()
             && Environment::year == CatastrophicDistYear 	// It is the disturbance year
             && Environment::week == CatastrophicDistWeek) 	// It is the disturbance week
     {
+        Profiler::Scope scope(Profile, Profiler::Seasonal);
         RunCatastrophicDisturbance();
     }
 
-    RemovePlants();    		// Remove decomposed plants and remove them from their genets
+    {
+        Profiler::Scope scope(Profile, Profiler::RemovePlants);
+        RemovePlants();    		// Remove decomposed plants and remove them from their genets
+    }
 
     if (SeedRainType > 0 && week == 21)
     {
+        Profiler::Scope scope(Profile, Profiler::Seasonal);
         SeedRain();
     }
 
-    EstablishmentLottery(); // for seeds and ramets
+    {
+        Profiler::Scope scope(Profile, Profiler::EstablishmentLottery);
+        EstablishmentLottery(); // for seeds and ramets
+    }
 
     if (week == 20)
     {
+        Profiler::Scope scope(Profile, Profiler::Seasonal);
         SeedMortalityAge(); // Remove non-dormant seeds before autumn
     }
 
     if (week == WeeksPerYear)
     {
+        Profiler::Scope scope(Profile, Profiler::Seasonal);
         Winter();           	// removal of aboveground biomass and decomposed plants
         SeedMortalityWinter();  // winter seed mortality
     }
 
+    Profiler::Scope scope(Profile, Profiler::Output);
+
     if ((weekly == 1 || week == 20) &&
             !(mode == invasionCriterion &&
                     Environment::year <= Tmax_monoculture)) // Not a monoculture
@@ -194,6 +337,32 @@ bool GridEnvir::exitConditions()
     return false;
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Invasion criterion: the start of the first year after the monoculture, before the
+ * invader is seeded. Catastrophic disturbance: the start of the disturbance week.
+ */
+bool GridEnvir::atBranchPoint() const
+{
+    if (mode == invasionCriterion)
+    {
+        return year == Tmax_monoculture + 1 && week == 1;
+    }
+    if (mode == catastrophicDisturbance)
+    {
+        return year == CatastrophicDistYear && week == CatastrophicDistWeek;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+bool GridEnvir::hasBranchPoint() const
+{
+    return (mode == invasionCriterion && Tmax_monoculture < Tmax) ||
+            (mode == catastrophicDisturbance && CatastrophicDistYear <= Tmax);
+}
+
 //-----------------------------------------------------------------------------
 
 void GridEnvir::SeedRain()
@@ -266,7 +435,7 @@ void GridEnvir::print_srv_and_PFT(const std::vector< std::shared_ptr<Plant> > &
 {
 
     // Create the data structure necessary to aggregate individuals
-    auto PFT_map = buildPFT_map(PlantList);
+    auto PFT_map = buildPFT_map();
 
     // If any PFT went extinct, record it in "srv" stream
     if (srv_out != 0)
@@ -278,16 +447,16 @@ void GridEnvir::print_srv_and_PFT(const std::vector< std::shared_ptr<Plant> > &
             {
                 Environment::PftSurvTime[it.first] = Environment::year;
 
-                std::ostringstream s_ss;
+                OutputTable & srv_row = output.srv_table;
 
-                s_ss << getSimID()	<< ", ";
-                s_ss << it.first 						<< ", "; // PFT name
-                s_ss << Environment::year				<< ", ";
-                s_ss << it.second.Pop 					<< ", ";
-                s_ss << it.second.Shootmass 			<< ", ";
-                s_ss << it.second.Rootmass 					   ;
+                srv_row << getSimID();
+                srv_row << it.first; // PFT name
+                srv_row << Environment::year;
+                srv_row << it.second.Pop;
+                srv_row << it.second.Shootmass;
+                srv_row << it.second.Rootmass;
 
-                output.print_row(s_ss, output.srv_stream);
+                srv_row.EndRow();
             }
         }
     }
@@ -305,18 +474,18 @@ void GridEnvir::print_srv_and_PFT(const std::vector< std::shared_ptr<Plant> > &
                 continue;
             }
 
-            std::ostringstream p_ss;
+            OutputTable & pft_row = output.PFT_table;
 
-            p_ss << getSimID()	<< ", ";
-            p_ss << it.first 						<< ", "; // PFT name
-            p_ss << Environment::year 				<< ", ";
-            p_ss << Environment::week 				<< ", ";
-            p_ss << it.second.Pop 					<< ", ";
-            p_ss << it.second.Shootmass 			<< ", ";
-            p_ss << it.second.Rootmass 				<< ", ";
-            p_ss << it.second.Repro 					   ;
+            pft_row << getSimID();
+            pft_row << it.first; // PFT name
+            pft_row << Environment::year;
+            pft_row << Environment::week;
+            pft_row << it.second.Pop;
+            pft_row << it.second.Shootmass;
+            pft_row << it.second.Rootmass;
+            pft_row << it.second.Repro;
 
-            output.print_row(p_ss, output.PFT_stream);
+            pft_row.EndRow();
         }
     }
 
@@ -324,27 +493,34 @@ void GridEnvir::print_srv_and_PFT(const std::vector< std::shared_ptr<Plant> > &
     PFT_map.clear();
 }
 
-map<string, PFT_struct> GridEnvir::buildPFT_map(const std::vector< std::shared_ptr<Plant> > & PlantList)
+map<string, PFT_struct> GridEnvir::buildPFT_map()
 {
-    map<string, PFT_struct> PFT_map;
+    // Aggregate the masses of the individuals by PFT number, in one pass over the PlantStore
+    vector<PFT_struct> byNr(traits.pftByNr.size());
 
-    for (auto const& it : traits.pftTraitTemplates)
+    for (int i = 0; i < Population.size(); i++)
     {
-        PFT_map[it.first] = PFT_struct();
+        if (Population.isDead[i])
+            continue;
+
+        PFT_struct & s = byNr[Population.pft[i]];
+
+        s.Rootmass = s.Rootmass + Population.mRoot[i];
+        s.Shootmass = s.Shootmass + Population.mShoot[i];
+        s.Repro = s.Repro + Population.mRepro[i];
     }
 
-    // Aggregate individuals
-    for (auto const& p : PlantList)
-    {
-        if (p->isDead)
-            continue;
+    // the populations are counted by the statistics
+    const vector<int> & Pop = Population.Stats.Pop;
+
+    map<string, PFT_struct> PFT_map;
 
-        PFT_struct* s = &(PFT_map[p->pft()]);
+    for (auto const& it : traits.pftTraitTemplates)
+    {
+        int nr = it.second->PFT_nr;
 
-        s->Pop = s->Pop + 1;
-        s->Rootmass = s->Rootmass + p->mRoot;
-        s->Shootmass = s->Shootmass + p->mShoot;
-        s->Repro = s->Repro + p->mRepro;
+        PFT_map[it.first] = byNr[nr];
+        PFT_map[it.first].Pop = (nr < int(Pop.size())) ? Pop[nr] : 0;
     }
 
     return PFT_map;
@@ -380,82 +556,100 @@ void GridEnvir::print_trait()
 
 void GridEnvir::print_ind(const std::vector< std::shared_ptr<Plant> > & PlantList)
 {
-    for (auto const& p : PlantList)
-    {
-        if (p->isDead) continue;
+    Population.UpdateGeometry();
 
-        std::ostringstream ss;
+    // the rows go straight into the buffer of the run, this is the largest table by far
+    const std::string simID = getSimID();
+    OutputTable & row = output.ind_table;
 
-        ss << getSimID()	<< ", ";
-        ss << p->plantID 					<< ", ";
-        ss << p->pft() 						<< ", ";
-        ss << Environment::year 			<< ", ";
-        ss << Environment::week 			<< ", ";
-        ss << p->y 							<< ", ";
-        ss << p->x 							<< ", ";
-        ss << p->traits->LMR 				<< ", ";
-        ss << p->traits->m0 				<< ", ";
-        ss << p->traits->maxMass 			<< ", ";
-        ss << p->traits->seedMass 			<< ", ";
-        ss << p->traits->dispersalDist 		<< ", ";
-        ss << p->traits->SLA 				<< ", ";
-        ss << p->traits->palat 				<< ", ";
-        ss << p->traits->Gmax 				<< ", ";
-        ss << p->traits->memory 			<< ", ";
-        ss << p->traits->clonal 			<< ", ";
-        ss << p->traits->meanSpacerlength 	<< ", ";
-        ss << p->traits->sdSpacerlength 	<< ", ";
-        ss << p->genet.lock()->genetID		<< ", ";
-        ss << p->age 						<< ", ";
-        ss << p->mShoot						<< ", ";
-        ss << p->mRoot 						<< ", ";
-        ss << p->Radius_shoot() 			<< ", ";
-        ss << p->Radius_root() 				<< ", ";
-        ss << p->mRepro 					<< ", ";
-        ss << p->lifetimeFecundity 			<< ", ";
-        ss << p->isStressed						   ;
-
-        output.print_row(ss, output.ind_stream);
+    for (auto const& p : PlantList)
+    {
+        if (p->isDead()) continue;
+
+        row << simID;
+        row << p->plantID;
+        row << p->pft();
+        row << Environment::year;
+        row << Environment::week;
+        row << p->y;
+        row << p->x;
+        row << p->traits->LMR;
+        row << p->traits->m0;
+        row << p->traits->maxMass;
+        row << p->traits->seedMass;
+        row << p->traits->dispersalDist;
+        row << p->traits->SLA;
+        row << p->traits->palat;
+        row << p->traits->Gmax;
+        row << p->traits->memory;
+        row << p->traits->clonal;
+        row << p->traits->meanSpacerlength;
+        row << p->traits->sdSpacerlength;
+        row << p->genet.lock()->genetID;
+        row << p->age;
+        row << p->mShoot();
+        row << p->mRoot();
+        row << p->Radius_shoot();
+        row << p->Radius_root();
+        row << p->mRepro();
+        row << p->lifetimeFecundity;
+        row << p->isStressed();
+        row.EndRow();
     }
 }
 void GridEnvir::print_aggregated(const std::vector< std::shared_ptr<Plant> > & PlantList)
 {
 
-    auto PFT_map = buildPFT_map(PlantList);
+    auto PFT_map = buildPFT_map();
 
     std::map<std::string, double> meanTraits = output.calculateMeanTraits(PlantList);
 
-    std::ostringstream ss;
+    OutputTable & row = output.aggregated_table;
 
-    ss << getSimID() 											<< ", ";
-    ss << Environment::year															<< ", ";
-    ss << Environment::week 														<< ", ";
-    ss << output.BlwgrdGrazingPressure.back()                                              << ", ";
-    ss << output.ContemporaneousRootmassHistory.back()                                 	<< ", ";
-    ss << output.calculateShannon(PFT_map) 												<< ", ";
-    ss << output.calculateRichness(PFT_map)												<< ", ";
+    row << getSimID();
+    row << Environment::year;
+    row << Environment::week;
+    row << output.BlwgrdGrazingPressure.back();
+    row << output.ContemporaneousRootmassHistory.back();
+    row << output.calculateShannon(PFT_map);
+    row << output.calculateRichness(PFT_map);
 
     double brayCurtis = output.calculateBrayCurtis(PFT_map, CatastrophicDistYear - 1, year);
     if (!Environment::AreSame(brayCurtis, -1))
     {
-        ss << brayCurtis 															<< ", ";
+        row << brayCurtis;
     }
     else
     {
-        ss << "NA"																	<< ", ";
+        row.NA();
     }
 
-    ss << output.TotalAboveComp.back()                                                     << ", ";
-    ss << output.TotalBelowComp.back()                                                     << ", ";
-    ss << output.TotalShootmass.back()                                                     << ", ";
-    ss << output.TotalRootmass.back()                                                      << ", ";
-    ss << output.TotalNonClonalPlants.back()                                               << ", ";
-    ss << output.TotalClonalPlants.back()                                                  << ", ";
-    ss << meanTraits["LMR"] 														<< ", ";
-    ss << meanTraits["MaxMass"] 													<< ", ";
-    ss << meanTraits["Gmax"] 														<< ", ";
-    ss << meanTraits["SLA"] 													           ;
+    row << output.TotalAboveComp.back();
+    row << output.TotalBelowComp.back();
+    row << output.TotalShootmass.back();
+    row << output.TotalRootmass.back();
+    row << output.TotalNonClonalPlants.back();
+    row << output.TotalClonalPlants.back();
+    row << meanTraits["LMR"];
+    row << meanTraits["MaxMass"];
+    row << meanTraits["Gmax"];
+    row << meanTraits["SLA"];
+
+    row.EndRow();
+
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * One row of the profile: the given year or "total" for the whole run.
+ */
+void GridEnvir::print_profile(const std::string & aYear, const std::string & aRow)
+{
+    std::ostringstream ss;
 
-    output.print_row(ss, output.aggregated_stream);
+    ss << getSimID()    << ", ";
+    ss << aYear         << ", ";
+    ss << aRow;
 
+    output.print_row(ss, output.profile_stream);
 }
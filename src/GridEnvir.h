@@ -4,6 +4,9 @@
 
 #include <string>
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class GridEnvir: public Grid, public CThread
 {
 
@@ -12,6 +15,9 @@ public:
 	GridEnvir();
 
 	void InitRun();
+	void ResumeRun(CheckpointReader & aReader);   // instead of InitRun, continues a run from its checkpoint
+	void SaveRun(CheckpointWriter & aWriter, int aYear, int aWeek) const; // the run continues with week aWeek of year aYear
+	void BranchRun(CheckpointReader & aReader); // continues the burn-in of another repetition
 	void OneYear();   // runs one year in default mode
 	void OneRun();    // runs one simulation run in default mode
 	void OneWeek();   // calls all weekly processes
@@ -19,15 +25,28 @@ public:
 	void InitInds();
 
 	bool exitConditions();
+	bool atBranchPoint() const;  // the week in which the repetitions of an invasion or disturbance line part
+	bool hasBranchPoint() const; // whether the run gets there
 
 	void SeedRain();  // distribute seeds on the grid each year
+
+protected:
+    bool Resumed;       // continued from a checkpoint, the param and trait rows are written already
+    bool Interrupted;   // stopped by SIGTERM after its checkpoint was written
+
+    virtual void SaveCheckpoint(int aYear, int aWeek) { }  // writes the checkpoint of the run (CSimulation)
+    virtual void Branch() { }                              // the burn-in shared by the repetitions ends (CSimulation)
+    virtual void WriteOutput() { }                         // hands full blocks of rows to the writer (CSimulation)
+
 private:
+    void setupRun();    // the grid of the parameters, without plants and seeds
     void print_param(); // prints general parameterization data
     void print_srv_and_PFT(const std::vector< std::shared_ptr<Plant> > & PlantList); 	// prints PFT data
-    std::map<std::string, PFT_struct> buildPFT_map(const std::vector< std::shared_ptr<Plant> > & PlantList);
+    std::map<std::string, PFT_struct> buildPFT_map();  // masses and populations of the living plants by PFT
     void print_trait(); // prints the traits of each PFT
     void print_ind(const std::vector< std::shared_ptr<Plant> > & PlantList); 			// prints individual data
     void print_aggregated(const std::vector< std::shared_ptr<Plant> > & PlantList);		// prints longitudinal data that's not just each PFT
+    void print_profile(const std::string & aYear, const std::string & aRow);         // prints time and work of the weekly phases
 
 };
 
@@ -2,6 +2,7 @@
 #include <string>
 #include <sstream>
 #include <memory>
+#include <map>
 #include <cassert>
 
 #include "CThread.h"
@@ -11,12 +12,12 @@
 #include "GridEnvir.h"
 #include "Parameters.h"
 #include "CSimulation.h"
+#include "CScheduler.h"
+#include "Checkpoint.h"
 #include "RandomGenerator.h"
 
 using namespace std;
 
-long   GridSize = 173;   //  Side length in cm
-
 int    startseed  = -1;
 int    linetoexec = -1;
 int    proctoexec =  1;
@@ -29,9 +30,7 @@ std::string outputPrefix = DEFAULT_OUTPREFIX;
 
 string configfilename;
 
-RandomGenerator rng;
-
-Output output;
+Parameters settings;    // prototype of the parameters of every run, holds the command line settings
 //   Support functions for program parameters
 //
 //   This is the usage dumper to the console.
@@ -41,12 +40,60 @@ static void dump_help() {
             "\t\t-h/--help : print this usage information\n"
             "\t\t-c        : use this file with configuration data\n"
             "\t\t-n        : line to execute in simulation\n"
-            "\t\t-p        : number of processors to use\n"
-            "\t\t-s        : set a starting seed for random number generators\n";
+            "\t\t-p        : number of runs to execute in parallel threads\n"
+            "\t\t-s        : start seed, every run derives its own random number stream from it (default: drawn and reported)\n"
+            "\t\t--coverage=lists|csr : how the zones of influence are mapped onto the grid (default csr)\n"
+            "\t\t--above-competition=sym|asympart|asymtot : aboveground competition mode (default asympart)\n"
+            "\t\t--below-competition=sym|asympart|asymtot : belowground competition mode (default sym)\n"
+            "\t\t--profile=off|run|year : time the weekly phases, write <outputprefix>_profile.csv (default off)\n"
+            "\t\t--gridsize=n : side length of the grid in cells (default 173)\n"
+            "\t\t--rng=mt19937|xoshiro256 : engine of the random number streams (default mt19937)\n"
+            "\t\t--grazing=weighted|rounds : bites drawn by palatability or the original grazing rounds (default weighted)\n"
+            "\t\t--checkpoint=n : checkpoint every run each n years and when stopped by SIGTERM (0: only then)\n"
+            "\t\t--resume : continue the batch from its checkpoints, with the same options and files\n"
+            "\t\t--shared-burnin : the repetitions of an invasion or disturbance line continue from one burn-in\n"
+            "\t\t--output=csv|binary : srv, PFT, ind and aggregated tables as text or typed columns, see util/post-processing/ibc2csv.py (default csv)\n"
+            "\t\t--compress=all|<tables> : gzip the tables, all or a list like ind,PFT of param, trait, srv, PFT, ind, aggregated, profile\n";
     exit(0);
 
 }
 //
+//  Competition mode from its name: size symmetric, partially or totally size asymmetric
+static CompMode parse_competition_mode(const std::string & aName, const std::string & aValue) {
+    if (aValue == "sym") {
+        return sym;
+    } else if (aValue == "asympart") {
+        return asympart;
+    } else if (aValue == "asymtot") {
+        return asymtot;
+    }
+    std::cerr << "unknown value for " << aName << " : " << aValue << "\n";
+    dump_help();
+    return sym;
+}
+//
+//  The set of output tables from a comma separated list of their names
+static int parse_tables(const std::string & aName, const std::string & aValue) {
+    static const std::map<std::string, int> tables {
+        { "param", paramTable }, { "trait", traitTable }, { "srv", srvTable }, { "PFT", PFTTable },
+        { "ind", indTable }, { "aggregated", aggregatedTable }, { "profile", profileTable }, { "all", allTables }
+    };
+
+    int set = 0;
+    std::stringstream ss(aValue);
+    std::string table;
+
+    while (getline(ss, table, ',')) {
+        auto it = tables.find(table);
+        if (it == tables.end()) {
+            std::cerr << "unknown table for " << aName << " : " << table << "\n";
+            dump_help();
+        }
+        set |= it->second;
+    }
+    return set;
+}
+//
 //
 //  This is the processing function for long parameters.
 //  It splits the argument at the equal sign into name and value string
@@ -56,6 +103,75 @@ static void process_long_parameter(string aLongParameter) {
 
     if (name == "help") {
         dump_help();
+    } else if (name == "coverage") {
+        if (value == "lists") {
+            settings.coverage = listCoverage;
+        } else if (value == "csr") {
+            settings.coverage = csrCoverage;
+        } else {
+            std::cerr << "unknown value for coverage : " << value << "\n";
+            dump_help();
+        }
+    } else if (name == "profile") {
+        if (value == "off") {
+            settings.profile = noProfile;
+        } else if (value == "run") {
+            settings.profile = runProfile;
+        } else if (value == "year") {
+            settings.profile = yearlyProfile;
+        } else {
+            std::cerr << "unknown value for profile : " << value << "\n";
+            dump_help();
+        }
+    } else if (name == "rng") {
+        if (value == "mt19937") {
+            settings.generator = mersenneTwister;
+        } else if (value == "xoshiro256") {
+            settings.generator = xoshiro256;
+        } else {
+            std::cerr << "unknown value for rng : " << value << "\n";
+            dump_help();
+        }
+    } else if (name == "grazing") {
+        if (value == "weighted") {
+            settings.grazing = weightedGrazing;
+        } else if (value == "rounds") {
+            settings.grazing = roundsGrazing;
+        } else {
+            std::cerr << "unknown value for grazing : " << value << "\n";
+            dump_help();
+        }
+    } else if (name == "checkpoint") {
+        settings.checkpointYears = atoi(value.c_str());
+        if (settings.checkpointYears < 0 || value.empty()) {
+            std::cerr << "invalid value for checkpoint : " << value << "\n";
+            dump_help();
+        }
+    } else if (name == "resume") {
+        settings.resume = true;
+    } else if (name == "shared-burnin") {
+        settings.sharedBurnIn = true;
+    } else if (name == "compress") {
+        settings.compressed = parse_tables(name, value);
+    } else if (name == "output") {
+        if (value == "csv") {
+            settings.format = csvOutput;
+        } else if (value == "binary") {
+            settings.format = binaryOutput;
+        } else {
+            std::cerr << "unknown value for output : " << value << "\n";
+            dump_help();
+        }
+    } else if (name == "gridsize") {
+        settings.GridSize = atol(value.c_str());
+        if (settings.GridSize < 1) {
+            std::cerr << "invalid value for gridsize : " << value << "\n";
+            dump_help();
+        }
+    } else if (name == "above-competition") {
+        settings.AboveCompMode = parse_competition_mode(name, value);
+    } else if (name == "below-competition") {
+        settings.BelowCompMode = parse_competition_mode(name, value);
     } else {
         std::cerr << "unknown parameter : " << name << "\n";
     }
@@ -160,7 +276,46 @@ int main(int argc, char* argv[])
          i++;
      }
 
+#ifndef HAVE_ZLIB
+    if (settings.compressed != 0) {
+        cerr << "Built without zlib, the output tables are written uncompressed\n";
+        settings.compressed = 0;
+    }
+#endif
+
+    //  The branches of a shared burn-in exist only in memory, a checkpoint could not restore them
+    if (settings.sharedBurnIn && (settings.checkpointYears >= 0 || settings.resume)) {
+        cerr << "--shared-burnin can not be combined with --checkpoint or --resume\n";
+        dump_help();
+    }
+
+    //
+    //  Every (line, repetition) pair is one run. The scheduler executes up to proctoexec
+    //  of them at the same time and writes their output in the order of submission.
+    CScheduler scheduler(proctoexec);
+
+    //  A resumed batch keeps its start seed and checkpoints
+    if (settings.resume) {
+        scheduler.Resume(outputPrefix, NameSimFile, linetoexec, startseed);
+
+        if (settings.checkpointYears < 0) {
+            settings.checkpointYears = 0;
+        }
+    }
+
+    //  Without a start seed the runs are still reproducible from the one reported here
+    if (startseed < 0) {
+        startseed = std::random_device()() & 0x7fffffff;
+    }
+    settings.startSeed = startseed;
+
     cerr << "Using simfile : " << NameSimFile << endl << "Using output prefix : " << outputPrefix << endl;
+    cerr << "Using start seed : " << startseed << endl;
+
+    if (settings.checkpointYears >= 0) {
+        scheduler.EnableCheckpoints(outputPrefix, NameSimFile, linetoexec, startseed);
+        Checkpoint::CatchSignals();
+    }
 
 
     //
@@ -183,23 +338,31 @@ int main(int argc, char* argv[])
 	while (getline(SimFile, data))
 	{
         if ((linetoexec == -1) || (linecounter == linetoexec)) {
-            for (int i = 0; i < _NRep; i++)
-            {
-                unique_ptr<CSimulation> run = unique_ptr<CSimulation>( new CSimulation() );
-                run->GetSim(data);
-                run->RunNr = i;
-
-                cout << run->getSimID() << endl;
-                cout << "Run " << run->RunNr << " \n";
-
-                run->InitRun();
-                run->OneRun();
+            if (settings.sharedBurnIn) {
+                //  The first repetition starts the others when its burn-in is done
+                scheduler.Submit(new CSimulation(settings, data, 0, _NRep), _NRep);
+            } else {
+                for (int i = 0; i < _NRep; i++)
+                {
+                    scheduler.Submit(new CSimulation(settings, data, i));
+                }
             }
         }
         linecounter++;
 	}
 
+    bool complete = scheduler.WaitAll();
+
 	SimFile.close();
 
+    if (!complete) {
+        if (settings.checkpointYears >= 0) {
+            cerr << "Stopped, the checkpoints are written. Continue the batch with --resume" << endl;
+        } else {
+            cerr << "The batch was not completed" << endl;
+        }
+        return 1;
+    }
+
 	return 0;
 }
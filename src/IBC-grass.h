@@ -3,12 +3,6 @@
 
 #include <string>
 
-#define getGridArea() GridSize*GridSize
-
-extern long GridSize;
-
 extern std::string NameSimFile;
 extern std::string outputPrefix;
-extern RandomGenerator rng;
-extern Output output;
 #endif // IBCGRASS_H
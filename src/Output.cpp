@@ -3,10 +3,17 @@
 #include <iterator>
 #include <cassert>
 #include <math.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include "itv_mode.h"
+#include "Traits.h"
+#include "Plant.h"
 #include "Output.h"
+#include "Profiler.h"
 #include "Environment.h"
+#include "Checkpoint.h"
 
 using namespace std;
 
@@ -70,6 +77,13 @@ const vector<string> Output::ind_header
          "i_stress"
     });
 
+const vector<string> Output::profile_header = [] ()
+    {
+        vector<string> header { "SimID", "Year" };
+        vector<string> columns = Profiler::Header();
+        header.insert(header.end(), columns.begin(), columns.end());
+        return header;
+    } ();
 
 Output::Output() :
         param_fn("data/out/param.txt"),
@@ -77,16 +91,29 @@ Output::Output() :
         srv_fn("data/out/srv.txt"),
         PFT_fn("data/out/PFT.txt"),
         ind_fn("data/out/ind.txt"),
-        aggregated_fn("data/out/aggregated.txt")
+        aggregated_fn("data/out/aggregated.txt"),
+        BlwgrdGrazingPressure(ReportHistory),
+        ContemporaneousRootmassHistory(ReportHistory),
+        TotalShootmass(ReportHistory),
+        TotalRootmass(ReportHistory),
+        TotalNonClonalPlants(ReportHistory),
+        TotalClonalPlants(ReportHistory),
+        TotalAboveComp(ReportHistory),
+        TotalBelowComp(ReportHistory),
+        srv_table(srv_header, "ttiirr"),
+        PFT_table(PFT_header, "ttiiirrr"),
+        ind_table(ind_header, "titiiii" "rrrrrrrr" "r" "i" "rr" "ii" "rrrrr" "ii"),
+        aggregated_table(aggregated_header, "tii" "rrrrr" "rrrrrrrrrr")
 {
-    BlwgrdGrazingPressure = { 0 };
-    ContemporaneousRootmassHistory = { 0 };
-    TotalShootmass = { 0 };
-    TotalRootmass = { 0 };
-    TotalAboveComp = { 0 };
-    TotalBelowComp = { 0 };
-    TotalNonClonalPlants = { 0 };
-    TotalClonalPlants = { 0 };
+    // Output belongs to the Environment of one run, so the series start anew with every run
+    BlwgrdGrazingPressure.push_back(0);
+    ContemporaneousRootmassHistory.push_back(0);
+    TotalShootmass.push_back(0);
+    TotalRootmass.push_back(0);
+    TotalAboveComp.push_back(0);
+    TotalBelowComp.push_back(0);
+    TotalNonClonalPlants.push_back(0);
+    TotalClonalPlants.push_back(0);
 }
 
 Output::~Output()
@@ -95,123 +122,267 @@ Output::~Output()
 }
 
 void Output::setupOutput(string _param_fn, string _trait_fn, string _srv_fn,
-                         string _PFT_fn, string _ind_fn, string _agg_fn)
+                         string _PFT_fn, string _ind_fn, string _agg_fn, string _profile_fn, bool binary)
 {
+    cleanup();
+
+    for (auto table : { &srv_table, &PFT_table, &ind_table, &aggregated_table })
+    {
+        table->SetBinary(binary);
+    }
+
     param_fn = _param_fn;
     trait_fn = _trait_fn;
     srv_fn = _srv_fn;
     PFT_fn = _PFT_fn;
     ind_fn = _ind_fn;
     aggregated_fn = _agg_fn;
+    profile_fn = _profile_fn;
+}
 
-    bool mid_batch = is_file_exist(param_fn.c_str());
-
-    param_stream.open(param_fn.c_str(), ios_base::app);
-    assert(param_stream.good());
-    if (!mid_batch) print_row(param_header, param_stream);
-
-    if (!trait_fn.empty())
+void Output::cleanup()
+{
+    for (auto stream : { &param_stream, &trait_stream, &profile_stream })
     {
-        trait_stream.open(trait_fn.c_str(), ios_base::app);
-        assert(trait_stream.good());
-        if (!mid_batch) print_row(trait_header, trait_stream);
+        stream->str("");
+        stream->clear();
     }
 
-    if (!PFT_fn.empty())
+    for (auto table : { &srv_table, &PFT_table, &ind_table, &aggregated_table })
     {
-        PFT_stream.open(PFT_fn.c_str(), ios_base::app);
-        assert(PFT_stream.good());
-        if (!mid_batch) print_row(PFT_header, PFT_stream);
+        table->Clear();
     }
+}
 
-    if (!ind_fn.empty())
+// Prints a row of data out a string, as a comma separated list with a newline at the end.
+void Output::print_row(std::ostringstream & ss, std::ostringstream & stream)
+{
+    assert(stream.good());
+
+    stream << ss.str() << '\n';
+}
+
+std::string Output::header_row(const vector<string> & row)
+{
+    std::ostringstream ss;
+
+    std::copy(row.begin(), row.end() - 1, std::ostream_iterator<string>(ss, ", "));
+
+    ss << row.back() << '\n';
+
+    return ss.str();
+}
+
+bool Output::BlockFull()
+{
+    for (auto stream : { &param_stream, &trait_stream, &profile_stream })
     {
-        ind_stream.open(ind_fn.c_str(), ios_base::app);
-        assert(ind_stream.good());
-        if (!mid_batch) print_row(ind_header, ind_stream);
+        if (size_t(stream->tellp()) >= BlockSize) return true;
     }
 
-    if (!srv_fn.empty())
+    for (auto table : { &srv_table, &PFT_table, &ind_table, &aggregated_table })
     {
-        srv_stream.open(srv_fn.c_str(), ios_base::app);
-        assert(srv_stream.good());
-        if (!mid_batch) print_row(srv_header, srv_stream);
+        if (table->Size() >= BlockSize) return true;
     }
 
+    return false;
+}
+
+/*
+ * Every table of the run gets its block, also without rows: the writer learns
+ * the files and headers of the run from them.
+ */
+std::vector<Output::PendingFile> Output::rows(bool aParam, bool aClear)
+{
+    std::vector<PendingFile> files;
+
+    if (aParam)
+        files.push_back({ param_fn, header_row(param_header), param_stream.str() });
+
+    if (!trait_fn.empty())
+        files.push_back({ trait_fn, header_row(trait_header), trait_stream.str() });
+
+    if (!PFT_fn.empty())
+        files.push_back({ PFT_fn, PFT_table.Header(), PFT_table.Rows() });
+
+    if (!ind_fn.empty())
+        files.push_back({ ind_fn, ind_table.Header(), ind_table.Rows() });
+
+    if (!srv_fn.empty())
+        files.push_back({ srv_fn, srv_table.Header(), srv_table.Rows() });
+
     if (!aggregated_fn.empty())
+        files.push_back({ aggregated_fn, aggregated_table.Header(), aggregated_table.Rows() });
+
+    if (!profile_fn.empty())
+        files.push_back({ profile_fn, header_row(profile_header), profile_stream.str() });
+
+    if (aClear) cleanup();
+
+    return files;
+}
+
+std::vector<Output::PendingFile> Output::TakeRows()
+{
+    return rows(true, true);
+}
+
+/*
+ * The repetitions of a shared burn-in (--shared-burnin) report its rows under their own
+ * IDs. Their param row is their own.
+ */
+std::vector<Output::PendingFile> Output::CopyRows(const std::string & aFrom, const std::string & aTo)
+{
+    Relabel(aFrom, aTo);
+    std::vector<PendingFile> files = rows(false, false);
+    Relabel(aTo, aFrom);
+
+    return files;
+}
+
+std::vector<std::string> Output::Filenames() const
+{
+    std::vector<std::string> files;
+
+    for (auto fn : { &param_fn, &trait_fn, &PFT_fn, &ind_fn, &srv_fn, &aggregated_fn, &profile_fn })
     {
-        aggregated_stream.open(aggregated_fn.c_str(), ios_base::app);
-        assert(aggregated_stream.good());
-        if (!mid_batch) print_row(aggregated_header, aggregated_stream);
+        if (!fn->empty()) files.push_back(*fn);
     }
+
+    return files;
 }
 
-bool Output::is_file_exist(const char *fileName)
+bool Output::IsCompressed(const std::string & aFilename)
 {
-    std::ifstream infile(fileName);
-    return infile.good();
+    const string gz = ".gz";
+
+    return aFilename.size() > gz.size() && aFilename.compare(aFilename.size() - gz.size(), gz.size(), gz) == 0;
 }
 
-void Output::cleanup()
+#ifdef HAVE_ZLIB
+/*
+ * Appends the block as one gzip member, deflated in slices. gzip, zcat and the readers
+ * of R and Python read a file of several members as one stream, so every block just adds
+ * its member (and --resume can still cut the file back after a run).
+ * Returns false if zlib fails, the caller reports it like a failed write.
+ */
+static bool writeCompressed(std::ostream & out, const string & data)
 {
-    if (Output::param_stream.is_open()) {
-        Output::param_stream.close();
-        Output::param_stream.clear();
-    }
+    const size_t Slice = 1 << 24;
+    vector<char> buffer(1 << 18);
 
-    if (Output::trait_stream.is_open()) {
-        Output::trait_stream.close();
-        Output::trait_stream.clear();
-    }
+    z_stream z = z_stream();
+    int result = deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY); // +16: gzip
 
-    if (Output::srv_stream.is_open()) {
-        Output::srv_stream.close();
-        Output::srv_stream.clear();
+    if (result != Z_OK)
+    {
+        cerr << "Could not start zlib: " << (z.msg ? z.msg : zError(result)) << endl;
+        return false;
     }
 
-    if (Output::PFT_stream.is_open()) {
-        Output::PFT_stream.close();
-        Output::PFT_stream.clear();
-    }
+    auto deflateInto = [&] (int flush)
+    {
+        do {
+            z.next_out = reinterpret_cast<Bytef*>(buffer.data());
+            z.avail_out = buffer.size();
+            result = deflate(&z, flush);
+
+            if (result == Z_STREAM_ERROR)
+            {
+                return false;
+            }
+            out.write(buffer.data(), buffer.size() - z.avail_out);
+        } while (z.avail_out == 0);
+
+        return true;
+    };
 
-    if (Output::ind_stream.is_open()) {
-        Output::ind_stream.close();
-        Output::ind_stream.clear();
+    bool deflated = true;
+
+    for (size_t pos = 0; deflated && pos < data.size(); pos += Slice)
+    {
+        z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + pos));
+        z.avail_in = min(Slice, data.size() - pos);
+        deflated = deflateInto(Z_NO_FLUSH);
     }
 
-    if (Output::aggregated_stream.is_open()) {
-        Output::aggregated_stream.close();
-        Output::aggregated_stream.clear();
+    deflated = deflated && deflateInto(Z_FINISH) && result == Z_STREAM_END;
+
+    if (!deflated)
+    {
+        cerr << "zlib could not compress a block: " << (z.msg ? z.msg : zError(result)) << endl;
     }
-}
 
+    deflateEnd(&z);
+    return deflated;
+}
+#endif
 
+/*
+ * aCompressed: the block belongs to a .gz table, it may go to a temporary file first.
+ */
+bool Output::WriteBlock(const std::string & aFilename, const std::string & aData, bool aCompressed)
+{
+    std::ofstream stream(aFilename.c_str(), ios_base::app | ios_base::binary);
 
+#ifdef HAVE_ZLIB
+    if (aCompressed)
+    {
+        return writeCompressed(stream, aData) && stream.good();
+    }
+#endif
 
+    stream << aData;
+    return stream.good();
+}
 
-// Prints a row of data out a string, as a comma separated list with a newline at the end.
-void Output::print_row(std::ostringstream & ss, ofstream & stream)
+/*
+ * The rows are written up to the checkpoint, the run hands them over before. The file names
+ * are not saved either, they follow from the SimFile line of the run.
+ */
+void Output::SaveState(CheckpointWriter & aWriter) const
 {
-    assert(stream.good());
-
-    stream << ss.str() << endl;
+    for (auto series : { &BlwgrdGrazingPressure, &ContemporaneousRootmassHistory, &TotalShootmass, &TotalRootmass,
+                         &TotalNonClonalPlants, &TotalClonalPlants, &TotalAboveComp, &TotalBelowComp })
+    {
+        series->SaveState(aWriter);
+    }
 
-    stream.flush();
+    aWriter.Write(BC_predisturbance_Pop);
 }
 
-void Output::print_row(vector<string> row, ofstream & stream)
+void Output::LoadState(CheckpointReader & aReader)
 {
-    assert(stream.good());
+    cleanup();
 
-    std::ostringstream ss;
+    for (auto series : { &BlwgrdGrazingPressure, &ContemporaneousRootmassHistory, &TotalShootmass, &TotalRootmass,
+                         &TotalNonClonalPlants, &TotalClonalPlants, &TotalAboveComp, &TotalBelowComp })
+    {
+        series->LoadState(aReader);
+    }
 
-    std::copy(row.begin(), row.end() - 1, std::ostream_iterator<string>(ss, ", "));
+    aReader.Read(BC_predisturbance_Pop);
+}
 
-    ss << row.back();
+/*
+ * Every row starts with the ID of its run. A branch of a shared burn-in (--shared-burnin)
+ * reports the rows of the burn-in under its own ID.
+ */
+void Output::Relabel(const std::string & aFrom, const std::string & aTo)
+{
+    for (auto stream : { &param_stream, &trait_stream, &profile_stream })
+    {
+        const string relabeled = OutputTable::RelabelRows(stream->str(), aFrom, aTo);
 
-    stream << ss.str() << endl;
+        stream->str("");
+        stream->clear();
+        *stream << relabeled;
+    }
 
-    stream.flush();
+    for (auto table : { &srv_table, &PFT_table, &ind_table, &aggregated_table })
+    {
+        table->Relabel(aFrom, aTo);
+    }
 }
 
 double Output::calculateShannon(const std::map<std::string, PFT_struct> & _PFT_map)
@@ -326,7 +497,7 @@ std::map<std::string, double> Output::calculateMeanTraits(const std::vector< std
 
     for (auto const& p : PlantList)
     {
-        if (p->isDead)
+        if (p->isDead())
         {
             continue;
         }
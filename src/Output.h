@@ -2,10 +2,18 @@
 #define SRC_OUTPUT_H_
 
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
 
-#include "Grid.h"
+#include "RingBuffer.h"
+#include "OutputTable.h"
+
+class Plant;
+class CheckpointWriter;
+class CheckpointReader;
 
 struct PFT_struct
 {
@@ -47,6 +55,9 @@ private:
     // Environmental and incidental data collection
     static const std::vector<std::string> aggregated_header;
 
+    // Time and work of the weekly phases (Profiler)
+    static const std::vector<std::string> profile_header;
+
     // Filenames
     std::string param_fn;
     std::string trait_fn;
@@ -54,15 +65,25 @@ private:
     std::string PFT_fn;
     std::string ind_fn;
     std::string aggregated_fn;
-
-    bool is_file_exist(const char *fileName);
+    std::string profile_fn;
 
 public:
+    // A block of rows of one table of a run, on its way to the file
+    struct PendingFile
+    {
+        std::string filename;
+        std::string header;
+        std::string rows;
+    };
+
+    // A run hands its rows over to the writer once one of its tables buffers that many bytes
+    static const size_t BlockSize = 4 << 20;
 
     Output();
     ~Output();
 
-    void setupOutput(std::string param_fn, std::string trait_fn, std::string srv_fn, std::string PFT_fn, std::string ind_fn, std::string agg_fn);
+    void setupOutput(std::string param_fn, std::string trait_fn, std::string srv_fn, std::string PFT_fn, std::string ind_fn, std::string agg_fn,
+                     std::string profile_fn = "", bool binary = false);  // binary: srv, PFT, ind and aggregated as OutputTable chunks
     void cleanup();
 
 //    void print_param(); // prints general parameterization data
@@ -72,26 +93,43 @@ public:
     double calculateBrayCurtis(const std::map<std::string, PFT_struct> & _PFT_map, int benchmarkYear, int theYear); // Bray-Curtis only makes sense with catastrophic disturbances
     std::map<std::string, double> calculateMeanTraits(const std::vector< std::shared_ptr<Plant> > & PlantList);
 
-    void print_row(std::ostringstream &ss, std::ofstream &stream);
-    void print_row(std::vector<std::string> row, std::ofstream &stream);
-
-    // aggregated output
-    std::vector<double> BlwgrdGrazingPressure;
-    std::vector<double> ContemporaneousRootmassHistory;
-    std::vector<double> TotalShootmass;
-    std::vector<double> TotalRootmass;
-    std::vector<double> TotalNonClonalPlants;
-    std::vector<double> TotalClonalPlants;
-    std::vector<double> TotalAboveComp;
-    std::vector<double> TotalBelowComp;
+    void print_row(std::ostringstream &ss, std::ostringstream &stream);
+    std::string header_row(const std::vector<std::string> & row);
+
+    bool BlockFull();                                           // a table buffers BlockSize bytes or more
+    std::vector<PendingFile> TakeRows();                        // hands over the buffered rows of every table
+    std::vector<PendingFile> CopyRows(const std::string & aFrom, const std::string & aTo); // of run aFrom as rows of run aTo, without param
+    std::vector<std::string> Filenames() const;                 // the files of the tables of this run
+    static bool IsCompressed(const std::string & aFilename);    // a .gz table (--compress)
+    static bool WriteBlock(const std::string & aFilename, const std::string & aData, bool aCompressed); // appends to the file
+
+    void SaveState(CheckpointWriter & aWriter) const;           // the aggregated series, the rows are handed over before
+    void LoadState(CheckpointReader & aReader);
+    void Relabel(const std::string & aFrom, const std::string & aTo); // the buffered rows of run aFrom become rows of run aTo
+
+    // aggregated output: the last values of each series, the aggregated rows print the latest one
+    static const int ReportHistory = 1;
+    RingBuffer<double> BlwgrdGrazingPressure;
+    RingBuffer<double> ContemporaneousRootmassHistory;
+    RingBuffer<double> TotalShootmass;
+    RingBuffer<double> TotalRootmass;
+    RingBuffer<double> TotalNonClonalPlants;
+    RingBuffer<double> TotalClonalPlants;
+    RingBuffer<double> TotalAboveComp;
+    RingBuffer<double> TotalBelowComp;
     std::map<std::string, int> BC_predisturbance_Pop;
 
-    std::ofstream param_stream;
-    std::ofstream trait_stream;
-    std::ofstream srv_stream;
-    std::ofstream PFT_stream;
-    std::ofstream ind_stream;
-    std::ofstream aggregated_stream;
+    // The rows of a run are buffered here until a block is full or the run is finished
+    std::ostringstream param_stream;
+    std::ostringstream trait_stream;
+    OutputTable srv_table;
+    OutputTable PFT_table;
+    OutputTable ind_table;
+    OutputTable aggregated_table;
+    std::ostringstream profile_stream;
+
+private:
+    std::vector<PendingFile> rows(bool aParam, bool aClear);   // the buffered rows of every table
 };
 
 #endif /* SRC_OUTPUT_H_ */
@@ -0,0 +1,540 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "OutputTable.h"
+
+using namespace std;
+
+static const char Magic[] = "IBCTAB2\n";
+
+//  Exponents of the real values without digits, in their mantissa 0
+enum Special : int16_t { Zero, Missing, NegativeZero, Infinity, NegativeInfinity, NaN, NegativeNaN };
+
+static void appendVarint(string & aOut, uint64_t aValue)
+{
+    while (aValue >= 0x80)
+    {
+        aOut += char(aValue | 0x80);
+        aValue >>= 7;
+    }
+    aOut += char(aValue);
+}
+
+static size_t varintSize(uint64_t aValue)
+{
+    size_t size = 1;
+
+    while (aValue >= 0x80)
+    {
+        aValue >>= 7;
+        size++;
+    }
+    return size;
+}
+
+//  Small negative values get small codes as well
+static uint64_t zigzag(int64_t aValue)
+{
+    return (uint64_t(aValue) << 1) ^ uint64_t(aValue >> 63);
+}
+
+static void append(string & aOut, const string & aText)
+{
+    appendVarint(aOut, aText.size());
+    aOut.append(aText);
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * The digits of the value as the text output prints it (%g, 6 significant digits):
+ * aMantissa * 10^aExponent, without trailing zeros in the mantissa.
+ */
+static void decimal(double aValue, int32_t & aMantissa, int16_t & aExponent)
+{
+    aMantissa = 0;
+
+    if (std::isnan(aValue))
+    {
+        aExponent = std::signbit(aValue) ? NegativeNaN : NaN;
+        return;
+    }
+    if (std::isinf(aValue))
+    {
+        aExponent = (aValue < 0) ? NegativeInfinity : Infinity;
+        return;
+    }
+    if (aValue == 0)
+    {
+        aExponent = std::signbit(aValue) ? NegativeZero : Zero;
+        return;
+    }
+
+    //  [-]d.ddddde[+-]x..
+    char text[32];
+    snprintf(text, sizeof(text), "%.5e", aValue);
+
+    const char* c = text;
+    const bool negative = (*c == '-');
+    if (negative) c++;
+
+    for (; *c != 'e'; c++)
+    {
+        if (*c != '.') aMantissa = aMantissa * 10 + (*c - '0');
+    }
+    int exponent = atoi(c + 1) - 5;
+
+    while (aMantissa % 10 == 0)
+    {
+        aMantissa /= 10;
+        exponent++;
+    }
+
+    aMantissa = negative ? -aMantissa : aMantissa;
+    aExponent = int16_t(exponent);
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * A column is stored as integers, in the smallest of four encodings for this chunk:
+ * 'p' the values, 'v' the differences to the value before (IDs that count up),
+ * 'r' runs of the same value (Year, Week) and 'd' the few distinct values of the
+ * column (PFTs, traits without ITV) with a packed index of as many bits as they need.
+ * All numbers are zigzag varints.
+ */
+template <typename T>
+static void appendColumn(string & aOut, const vector<T> & aValues)
+{
+    const size_t MaxDistinct = 1 << 16;
+
+    size_t plain = 0;
+    size_t delta = 0;
+    size_t runs = 0;
+    vector<pair<int64_t, uint64_t> > run;
+
+    unordered_map<int64_t, uint32_t> index;
+    vector<int64_t> distinct;
+    vector<uint32_t> indices;
+    size_t dictionary = 0;
+
+    int64_t previous = 0;
+
+    for (const T & value : aValues)
+    {
+        const int64_t v = value;
+
+        plain += varintSize(zigzag(v));
+        delta += varintSize(zigzag(v - previous));
+
+        if (run.empty() || v != previous)
+        {
+            run.push_back({ v, 0 });
+        }
+        run.back().second++;
+
+        if (distinct.size() <= MaxDistinct)
+        {
+            auto it = index.emplace(v, distinct.size());
+            if (it.second)
+            {
+                distinct.push_back(v);
+                dictionary += varintSize(zigzag(v));
+            }
+            indices.push_back(it.first->second);
+        }
+
+        previous = v;
+    }
+
+    for (auto const& r : run)
+    {
+        runs += varintSize(zigzag(r.first)) + varintSize(r.second);
+    }
+    runs += varintSize(run.size());
+
+    size_t bits = 0;
+    while ((size_t(1) << bits) < distinct.size())
+    {
+        bits++;
+    }
+    dictionary += varintSize(distinct.size()) + 1 + (aValues.size() * bits + 7) / 8;
+
+    if (distinct.size() <= MaxDistinct && dictionary <= min(min(plain, delta), runs))
+    {
+        aOut += 'd';
+        appendVarint(aOut, distinct.size());
+        for (int64_t v : distinct)
+        {
+            appendVarint(aOut, zigzag(v));
+        }
+        aOut += char(bits);
+
+        uint64_t buffer = 0;
+        size_t filled = 0;
+
+        for (uint32_t i : indices)
+        {
+            buffer |= uint64_t(i) << filled;
+            filled += bits;
+
+            for (; filled >= 8; filled -= 8)
+            {
+                aOut += char(buffer & 0xff);
+                buffer >>= 8;
+            }
+        }
+        if (filled > 0)
+        {
+            aOut += char(buffer);
+        }
+    }
+    else if (runs <= min(plain, delta))
+    {
+        aOut += 'r';
+        appendVarint(aOut, run.size());
+        for (auto const& r : run)
+        {
+            appendVarint(aOut, zigzag(r.first));
+            appendVarint(aOut, r.second);
+        }
+    }
+    else if (delta < plain)
+    {
+        aOut += 'v';
+        previous = 0;
+        for (const T & value : aValues)
+        {
+            appendVarint(aOut, zigzag(int64_t(value) - previous));
+            previous = value;
+        }
+    }
+    else
+    {
+        aOut += 'p';
+        for (const T & value : aValues)
+        {
+            appendVarint(aOut, zigzag(value));
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+OutputTable::OutputTable(const vector<string> & aNames, const string & aTypes) :
+        Names(aNames), Types(aTypes), Binary(false), Next(0), NRows(0), Columns(aTypes.size())
+{
+    assert(Names.size() == Types.size());
+}
+
+//-----------------------------------------------------------------------------
+
+void OutputTable::SetBinary(bool aBinary)
+{
+    Clear();
+    Binary = aBinary;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * An int goes into an int column, or into a real column as a double.
+ */
+OutputTable & OutputTable::operator<<(int aValue)
+{
+    if (!Binary)
+    {
+        if (Next++ > 0) Text << ", ";
+        Text << aValue;
+        return *this;
+    }
+
+    assert(Next < Types.size() && Types[Next] != 't');
+
+    if (Types[Next] == 'i')
+    {
+        Columns[Next].Ints.push_back(aValue);
+    }
+    else
+    {
+        //  with all its digits, as the text prints it
+        Columns[Next].Mantissas.push_back(aValue);
+        Columns[Next].Exponents.push_back(0);
+    }
+    Next++;
+
+    return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+OutputTable & OutputTable::operator<<(double aValue)
+{
+    if (!Binary)
+    {
+        if (Next++ > 0) Text << ", ";
+        Text << aValue;
+        return *this;
+    }
+
+    assert(Next < Types.size() && Types[Next] == 'r');
+
+    int32_t mantissa;
+    int16_t exponent;
+    decimal(aValue, mantissa, exponent);
+
+    Columns[Next].Mantissas.push_back(mantissa);
+    Columns[Next++].Exponents.push_back(exponent);
+
+    return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+OutputTable & OutputTable::operator<<(const string & aValue)
+{
+    if (!Binary)
+    {
+        if (Next++ > 0) Text << ", ";
+        Text << aValue;
+        return *this;
+    }
+
+    assert(Next < Types.size() && Types[Next] == 't');
+
+    Columns[Next++].Codes.push_back(code(aValue));
+
+    return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+void OutputTable::NA()
+{
+    if (!Binary)
+    {
+        if (Next++ > 0) Text << ", ";
+        Text << "NA";
+        return;
+    }
+
+    assert(Next < Types.size());
+
+    switch (Types[Next])
+    {
+    case 'i':
+        Columns[Next].Ints.push_back(numeric_limits<int32_t>::min());
+        break;
+    case 'r':
+        Columns[Next].Mantissas.push_back(0);
+        Columns[Next].Exponents.push_back(Missing);
+        break;
+    default:
+        Columns[Next].Codes.push_back(code("NA"));
+        break;
+    }
+    Next++;
+}
+
+//-----------------------------------------------------------------------------
+
+void OutputTable::EndRow()
+{
+    assert(!Binary || Next == Types.size());
+
+    if (!Binary)
+    {
+        Text << '\n';
+    }
+
+    Next = 0;
+    NRows++;
+}
+
+//-----------------------------------------------------------------------------
+
+string OutputTable::Header() const
+{
+    string header;
+
+    if (!Binary)
+    {
+        for (size_t i = 0; i < Names.size(); i++)
+        {
+            header += (i > 0 ? ", " : "") + Names[i];
+        }
+        return header + '\n';
+    }
+
+    header.append(Magic, sizeof(Magic) - 1);
+    appendVarint(header, Names.size());
+
+    for (size_t i = 0; i < Names.size(); i++)
+    {
+        header += Types[i];
+        append(header, Names[i]);
+    }
+
+    return header;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * A block without rows appends nothing. The chunk starts with its length, a reader
+ * takes one chunk at a time.
+ */
+string OutputTable::Rows() const
+{
+    if (!Binary)
+    {
+        return Text.str();
+    }
+
+    string chunk;
+
+    if (NRows == 0)
+    {
+        return chunk;
+    }
+
+    string body;
+
+    appendVarint(body, NRows);
+    appendVarint(body, Dictionary.size());
+    for (auto const& text : Dictionary)
+    {
+        append(body, text);
+    }
+
+    for (size_t i = 0; i < Columns.size(); i++)
+    {
+        switch (Types[i])
+        {
+        case 'i':
+            appendColumn(body, Columns[i].Ints);
+            break;
+        case 'r':
+            appendColumn(body, Columns[i].Exponents);
+            appendColumn(body, Columns[i].Mantissas);
+            break;
+        default:
+            appendColumn(body, Columns[i].Codes);
+            break;
+        }
+    }
+
+    appendVarint(chunk, body.size());
+    chunk += body;
+
+    return chunk;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * The binary columns are counted as 8 bytes a value.
+ */
+size_t OutputTable::Size()
+{
+    if (!Binary)
+    {
+        return Text.tellp();
+    }
+
+    return NRows * Columns.size() * sizeof(double);
+}
+
+//-----------------------------------------------------------------------------
+
+void OutputTable::Clear()
+{
+    Text.str("");
+    Text.clear();
+
+    Next = 0;
+    NRows = 0;
+
+    for (auto & column : Columns)
+    {
+        column = Column();
+    }
+    Dictionary.clear();
+    Codes.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void OutputTable::Relabel(const string & aFrom, const string & aTo)
+{
+    if (!Binary)
+    {
+        const string rows = RelabelRows(Text.str(), aFrom, aTo);
+
+        Text.str("");
+        Text.clear();
+        Text << rows;
+        return;
+    }
+
+    auto it = Codes.find(aFrom);
+
+    if (it != Codes.end())
+    {
+        uint32_t code = it->second;
+
+        Codes.erase(it);
+        Codes[aTo] = code;
+        Dictionary[code] = aTo;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Every row starts with the ID of its run.
+ */
+string OutputTable::RelabelRows(const string & aRows, const string & aFrom, const string & aTo)
+{
+    const string from = aFrom + ", ";
+    const string to = aTo + ", ";
+
+    string relabeled;
+    relabeled.reserve(aRows.size());
+
+    size_t begin = 0;
+    while (begin < aRows.size())
+    {
+        size_t end = aRows.find('\n', begin);
+        end = (end == string::npos) ? aRows.size() : end + 1;
+
+        if (aRows.compare(begin, from.size(), from) == 0)
+        {
+            relabeled += to;
+            relabeled.append(aRows, begin + from.size(), end - begin - from.size());
+        }
+        else
+        {
+            relabeled.append(aRows, begin, end - begin);
+        }
+        begin = end;
+    }
+
+    return relabeled;
+}
+
+//-----------------------------------------------------------------------------
+
+uint32_t OutputTable::code(const string & aValue)
+{
+    auto it = Codes.find(aValue);
+
+    if (it != Codes.end())
+    {
+        return it->second;
+    }
+
+    uint32_t code = Dictionary.size();
+
+    Dictionary.push_back(aValue);
+    Codes[aValue] = code;
+
+    return code;
+}
@@ -23,7 +23,11 @@ Parameters::Parameters() :
 		CatastrophicDistYear(100), CatastrophicDistWeek(20),
 		CatastrophicPlantMortality(0),
 		Aampl(0), Bampl(0),
-		SeedInput(0), SeedRainType(0)
+		SeedInput(0), SeedRainType(0),
+		GridSize(173),
+		coverage(csrCoverage), profile(noProfile), startSeed(0), generator(mersenneTwister),
+		grazing(weightedGrazing), checkpointYears(-1), resume(false), sharedBurnIn(false),
+		format(csvOutput), compressed(0)
 {
 
 }
@@ -19,6 +19,26 @@ enum stabilizationMode { version1, version2, version3 };
 
 enum experimentType { communityAssembly, invasionCriterion, catastrophicDisturbance };
 
+// How the zones of influence are mapped onto the cells: per cell lists of plants or flat arrays (ZOICoverage)
+enum coverageMode { listCoverage, csrCoverage };
+
+// Profile of the weekly phases: none, one row per run or one row per year and run
+enum profileMode { noProfile, runProfile, yearlyProfile };
+
+// Engine of the random number streams
+enum rngBackend { mersenneTwister, xoshiro256 };
+
+// Choice of the plants bitten by aboveground grazing: single bites drawn by palatability
+// (WeightedSampler) or the original rounds over the shuffled PlantList
+enum grazingMode { weightedGrazing, roundsGrazing };
+
+// Format of the srv, PFT, ind and aggregated tables: CSV text or typed columns (OutputTable)
+enum outputFormat { csvOutput, binaryOutput };
+
+// Output tables, a bit each in the set of gzip compressed tables (--compress)
+enum outputTable { paramTable = 1, traitTable = 2, srvTable = 4, PFTTable = 8, indTable = 16, aggregatedTable = 32,
+                   profileTable = 64, allTables = 127 };
+
 //---------------------------------------------------------------------------
 //
 //  This class hold all parameters that control the behaviour of the simulation in one run.
@@ -103,6 +123,20 @@ public:
 	int SeedInput;    // number of seeds introduced per PFT per year or seed mass introduced per PFT
 	int SeedRainType; // mode of seed input: 0 - no seed rain, 1 - some number of seeds
 
+	long GridSize;    // side length of the grid in cells (cm)
+
+	// Settings from the command line
+	coverageMode coverage;
+	profileMode profile;
+	unsigned int startSeed;    // the random number stream of every run is derived from it (-s)
+	rngBackend generator;
+	grazingMode grazing;
+	int checkpointYears;       // checkpoint of every run each n years, 0: only when stopped by SIGTERM, -1: none
+	bool resume;               // continue the batch from its checkpoints (--resume)
+	bool sharedBurnIn;         // the repetitions of a line branch from one burn-in (--shared-burnin)
+	outputFormat format;
+	int compressed;            // outputTable bits of the tables written as .gz
+
 	// Constructor
 	Parameters();
 
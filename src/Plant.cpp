@@ -9,8 +9,6 @@
 #include "Environment.h"
 #include "Traits.h"
 #include "RandomGenerator.h"
-#include "Output.h"
-#include "IBC-grass.h"
 
 using namespace std;
 
@@ -22,17 +20,16 @@ using namespace std;
  * Genet has to be defined externally.
  */
 
-int Plant::staticID = 0;
-
-Plant::Plant(const unique_ptr<Seed> & seed, ITV_mode itv) :
-		cell(NULL), mReproRamets(0), genet(),
-		plantID(++staticID), x(0), y(0),
-		age(0), mRepro(0), Ash_disc(0), Art_disc(0), Auptake(0), Buptake(0),
-		isStressed(0), isDead(false), toBeRemoved(false),
+Plant::Plant(const unique_ptr<Seed> & seed, ITV_mode itv, int aPlantID) :
+		cell(NULL), genet(),
+		plantID(aPlantID), x(0), y(0),
+		age(0), nCoveredA(0), nCoveredB(0),
+		toBeRemoved(false),
+		store(NULL), slot(-1),
 		spacerLengthToGrow(0)
 {
 
-    traits = make_unique<Traits>(*(seed->traits));
+    traits = seed->traits;
 
     if (itv == on) {
 		assert(traits->myTraitType == Traits::individualized);
@@ -40,9 +37,6 @@ Plant::Plant(const unique_ptr<Seed> & seed, ITV_mode itv) :
 		assert(traits->myTraitType == Traits::species);
 	}
 
-	mShoot = traits->m0;
-	mRoot = traits->m0;
-
 	//establish this plant on cell
 	setCell(seed->getCell());
 	if (cell)
@@ -57,24 +51,37 @@ Plant::Plant(const unique_ptr<Seed> & seed, ITV_mode itv) :
  * Clonal Growth - The new Plant inherits its parameters from 'plant'.
  * Genet is the same as for plant
  */
-Plant::Plant(double x, double y, const std::shared_ptr<Plant> & plant, ITV_mode itv) :
-		cell(NULL), mReproRamets(0), genet(plant->genet),
-		plantID(++staticID), x(x), y(y),
-		age(0), mRepro(0), Ash_disc(0), Art_disc(0), Auptake(0), Buptake(0),
-		isStressed(0), isDead(false), toBeRemoved(false),
+Plant::Plant(double x, double y, const std::shared_ptr<Plant> & plant, ITV_mode itv, int aPlantID) :
+		cell(NULL), genet(plant->genet),
+		plantID(aPlantID), x(x), y(y),
+		age(0), nCoveredA(0), nCoveredB(0),
+		toBeRemoved(false),
+		store(NULL), slot(-1),
 		spacerLengthToGrow(0)
 {
 
-    traits = make_unique<Traits>(*(plant->traits));
+    traits = plant->traits;
 
     if (itv == on) {
 		assert(traits->myTraitType == Traits::individualized);
 	} else {
 		assert(traits->myTraitType == Traits::species);
 	}
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Without cell, genet and state: Grid::LoadState sets them.
+ */
+Plant::Plant(const std::shared_ptr<const Traits> & aTraits, int aPlantID) :
+		cell(NULL), traits(aTraits), genet(),
+		plantID(aPlantID), x(0), y(0),
+		age(0), nCoveredA(0), nCoveredB(0),
+		toBeRemoved(false),
+		store(NULL), slot(-1),
+		spacerLengthToGrow(0)
+{
 
-	mShoot = traits->m0;
-	mRoot = traits->m0;
 }
 
 //---------------------------------------------------------------------------
@@ -86,10 +93,10 @@ Plant::~Plant()
 
 void Plant::weeklyReset()
 {
-	Auptake = 0;
-	Buptake = 0;
-	Ash_disc = 0;
-	Art_disc = 0;
+	Auptake() = 0;
+	Buptake() = 0;
+	Ash_disc() = 0;
+	Art_disc() = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -101,178 +108,47 @@ void Plant::setCell(Cell* _cell) {
 	this->cell->occupied = true;
 }
 
-//---------------------------------------------------------------------------
-/**
- * Growth of reproductive organs (seeds and spacer).
- */
-double Plant::ReproGrow(double uptake, int aWeek)
-{
-	double VegRes;
-
-	//fixed Proportion of resource to seed production
-	if (mRepro <= traits->allocSeed * mShoot)
-	{
-		double SeedRes = uptake * traits->allocSeed;
-		double SpacerRes = uptake * traits->allocSpacer;
-
-		// during the seed-production-weeks
-        if ((aWeek >= traits->flowerWeek) && (aWeek < traits->dispersalWeek))
-		{
-			//seed production
-			double dm_seeds = max(0.0, traits->growth * SeedRes);
-			mRepro += dm_seeds;
-
-			//clonal growth
-			double d = max(0.0, min(SpacerRes, uptake - SeedRes)); // for large AllocSeed, resources may be < SpacerRes, then only take remaining resources
-			mReproRamets += max(0.0, traits->growth * d);
-
-			VegRes = uptake - SeedRes - d;
-		}
-		else
-		{
-			VegRes = uptake - SpacerRes;
-			mReproRamets += max(0.0, traits->growth * SpacerRes);
-		}
-
-	}
-	else
-	{
-		VegRes = uptake;
-	}
-
-	return VegRes;
-}
-
 //-----------------------------------------------------------------------------
 /**
  * Growth of the spacer.
  */
 void Plant::SpacerGrow() {
 
-	if (growingSpacerList.size() == 0 || Environment::AreSame(mReproRamets, 0))
+	if (growingSpacerList.size() == 0 || Environment::AreSame(mReproRamets(), 0))
 	{
 		return;
 	}
 
-	double mGrowSpacer = mReproRamets / growingSpacerList.size(); //resources for one spacer
+	double mGrowSpacer = mReproRamets() / growingSpacerList.size(); //resources for one spacer
 
 	for (auto const& Spacer : growingSpacerList)
 	{
 		Spacer->spacerLengthToGrow = max(0.0, Spacer->spacerLengthToGrow - (mGrowSpacer / traits->mSpacer));
 	}
 
-	mReproRamets = 0;
-}
-
-//-----------------------------------------------------------------------------
-/**
- * two-layer growth
- * -# Resources for fecundity are allocated
- * -# According to the resources allocated and the respiration needs
- * shoot- and root-growth are calculated.
- * -# Stress-value is in- or decreased according to the uptake
- *
- * adapted growth formula with correction factor for the conversion rate
- * to simulate implicit biomass reduction via root herbivory
- */
-void Plant::Grow(int aWeek) //grow plant one timestep
-{
-	double dm_shoot, dm_root, alloc_shoot;
-	double LimRes, ShootRes, RootRes, VegRes;
-
-	/********************************************/
-	/*  dm/dt = growth*(c*m^p - m^q / m_max^r)  */
-	/********************************************/
-
-	// which resource is limiting growth?
-	LimRes = min(Buptake, Auptake); // two layers
-    VegRes = ReproGrow(LimRes, aWeek);
-	// allocation to shoot and root growth
-	alloc_shoot = Buptake / (Buptake + Auptake); // allocation coefficient
-
-	ShootRes = alloc_shoot * VegRes;
-	RootRes = VegRes - ShootRes;
-
-	// Shoot growth
-	dm_shoot = this->ShootGrow(ShootRes);
-
-	// Root growth
-	dm_root = this->RootGrow(RootRes);
-
-	mShoot += dm_shoot;
-	mRoot += dm_root;
-
-	if (stressed())
-	{
-		++isStressed;
-	}
-	else if (isStressed > 0)
-	{
-		--isStressed;
-	}
-
-}
-
-//-----------------------------------------------------------------------------
-/**
- * shoot growth : dm/dt = growth*(c*m^p - m^q / m_max^r)
- */
-double Plant::ShootGrow(double shres)
-{
-
-	double Assim_shoot;
-	double Resp_shoot;
-
-	// exponents for growth function
-	double p = 2.0 / 3.0;
-	double q = 2.0;
-	double r = 4.0 / 3.0;
-
-	Assim_shoot = traits->growth * min(shres, traits->Gmax * Ash_disc); //growth limited by maximal resource per area -> similar to uptake limitation
-	Resp_shoot = traits->growth * traits->SLA * pow(traits->LMR, p) * traits->Gmax * pow(mShoot, q) / pow(traits->maxMass, r); //respiration proportional to mshoot^2
-
-	return max(0.0, Assim_shoot - Resp_shoot);
-
-}
-
-//-----------------------------------------------------------------------------
-/**
- * root growth : dm/dt = growth*(c*m^p - m^q / m_max^r)
- */
-double Plant::RootGrow(double rres)
-{
-	double Assim_root, Resp_root;
-
-	//exponents for growth function
-	double q = 2.0;
-	double r = 4.0 / 3.0;
-
-	Assim_root = traits->growth * min(rres, traits->Gmax * Art_disc); //growth limited by maximal resource per area -> similar to uptake limitation
-	Resp_root = traits->growth * traits->Gmax * traits->RAR * pow(mRoot, q) / pow(traits->maxMass, r);  //respiration proportional to root^2
-
-	return max(0.0, Assim_root - Resp_root);
+	mReproRamets() = 0;
 }
 
 //-----------------------------------------------------------------------------
 
 bool Plant::stressed() const
 {
-	return (Auptake / 2.0 < minresA()) || (Buptake / 2.0 < minresB());
+	return (Auptake() / 2.0 < minresA()) || (Buptake() / 2.0 < minresB());
 }
 
 //-----------------------------------------------------------------------------
 /**
  * Kill plant depending on stress level and base mortality. Stochastic process.
  */
-void Plant::Kill(double aBackgroundMortality)
+void Plant::Kill(double aBackgroundMortality, RandomGenerator& aRng)
 {
 	assert(traits->memory >= 1);
 
-    double pmort = (double(isStressed) / double(traits->memory)) + aBackgroundMortality; // stress mortality + random background mortality
+    double pmort = (double(isStressed()) / double(traits->memory)) + aBackgroundMortality; // stress mortality + random background mortality
 
-    if (rng.get01() < pmort)
+    if (aRng.get01() < pmort)
 	{
-		isDead = true;
+		setDead();
 	}
 }
 
@@ -282,13 +158,13 @@ void Plant::Kill(double aBackgroundMortality)
  */
 void Plant::DecomposeDead(double aLitterDecomp) {
 
-	assert(isDead);
+	assert(isDead());
 
 	const double minmass = 10; // mass at which dead plants are removed
 
-	mRepro = 0;
-    mShoot *= aLitterDecomp;
-    mRoot *= aLitterDecomp;
+	mRepro() = 0;
+    mShoot() *= aLitterDecomp;
+    mRoot() *= aLitterDecomp;
 
 	if (GetMass() < minmass)
 	{
@@ -306,11 +182,11 @@ int Plant::ConvertReproMassToSeeds()
 {
 	int NSeeds = 0;
 
-	if (!isDead)
+	if (!isDead())
 	{
-		NSeeds = floor(mRepro / traits->seedMass);
+		NSeeds = floor(mRepro() / traits->seedMass);
 
-		mRepro = 0;
+		mRepro() = 0;
 	}
 
 	lifetimeFecundity += NSeeds;
@@ -326,8 +202,8 @@ int Plant::ConvertReproMassToSeeds()
  */
 int Plant::GetNRamets() const
 {
-	if (mReproRamets > 0 &&
-			!isDead &&
+	if (mReproRamets() > 0 &&
+			!isDead() &&
 			growingSpacerList.size() == 0) {
 		return 1;
 	}
@@ -343,11 +219,11 @@ double Plant::RemoveShootMass(double aBiteSize)
 {
 	double mass_removed = 0;
 
-	if (mShoot + mRepro > 1) // only remove mass if shootmass > 1 mg
+	if (mShoot() + mRepro() > 1) // only remove mass if shootmass > 1 mg
 	{
-        mass_removed = aBiteSize * mShoot + mRepro;
-        mShoot *= 1 - aBiteSize;
-		mRepro = 0;
+        mass_removed = aBiteSize * mShoot() + mRepro();
+        mShoot() *= 1 - aBiteSize;
+		mRepro() = 0;
 	}
 
 	return mass_removed;
@@ -359,12 +235,12 @@ double Plant::RemoveShootMass(double aBiteSize)
  */
 void Plant::RemoveRootMass(const double mass_removed)
 {
-	assert(mass_removed <= mRoot);
+	assert(mass_removed <= mRoot());
 
-	mRoot -= mass_removed;
+	mRoot() -= mass_removed;
 
-	if (Environment::AreSame(mRoot, 0)) {
-		isDead = true;
+	if (Environment::AreSame(mRoot(), 0)) {
+		setDead();
 	}
 }
 
@@ -374,8 +250,8 @@ void Plant::RemoveRootMass(const double mass_removed)
  */
 void Plant::WinterLoss(double aWinterDieback)
 {
-    mShoot *= 1 - aWinterDieback;
-	mRepro = 0;
+    mShoot() *= 1 - aWinterDieback;
+	mRepro() = 0;
 	age++;
 }
 
@@ -399,9 +275,9 @@ double Plant::comp_coef(const int layer, const int symmetry) const
 		break;
 	case 2:
 		if (layer == 1)
-			return mShoot * traits->CompPowerA();
+			return mShoot() * traits->CompPowerA();
 		if (layer == 2)
-			return mRoot * traits->CompPowerB();
+			return mRoot() * traits->CompPowerB();
 		break;
 	default:
 		cerr << "CPlant::comp_coef() - wrong input";
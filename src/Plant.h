@@ -2,6 +2,7 @@
 #define SRC_PLANT_H_
 
 #include <vector>
+#include <cassert>
 #include <cmath>
 #include <math.h>
 #include <string>
@@ -10,61 +11,55 @@
 #include "Genet.h"
 #include "Parameters.h"
 #include "Traits.h"
+#include "PlantStore.h"
 
 static const double Pi = std::atan(1) * 4;
 
 class Seed;
 class Cell;
 class Genet;
+class RandomGenerator;
 
 class Plant
 {
 private:
 	Cell* cell;
 
-    double ReproGrow(double uptake, int aWeek);
-	double ShootGrow(double shres);
-	double RootGrow(double rres);
-
-	double mReproRamets;			// resources for ramet growth
+	inline double& mReproRamets() { return store->mReproRamets[slot]; }	// resources for ramet growth
+	inline double mReproRamets() const { return store->mReproRamets[slot]; }
 
 public:
-	std::unique_ptr<Traits> traits;	// PFT Traits
+	std::shared_ptr<const Traits> traits;	// PFT Traits (shared with the seed and the other ramets)
 	std::weak_ptr<Genet> genet; 		// genet of the clonal plant
 
-	static int staticID;
 	int plantID;
 
 	int x;
 	int y;
 
 	int age;
-	double mShoot;   			// shoot mass
-	double mRoot;    			// root mass
-	double mRepro;    			// reproductive mass (converted to a discrete number of seeds)
 	int lifetimeFecundity = 0; 	// The total accumulation of seeds
 
-	int Ash_disc; 				// discrete above-ground ZOI area
-	int Art_disc; 				// discrete below-ground ZOI area
-
-	double Auptake; 			// uptake of above-ground resource in one time step
-	double Buptake; 			// uptake below-ground resource one time step
+	std::vector<int> coveredCells;	// grid cells of the largest ZOI so far, nearest first (see ZOICoverage)
+	int nCoveredA;				// number of coveredCells in the above-ground ZOI this week
+	int nCoveredB;				// number of coveredCells in the below-ground ZOI this week
 
-	int isStressed;     			// counter for weeks with resource stress exposure
-	bool isDead;      			// plant dead or alive?
 	bool toBeRemoved;    			// Should the plant be removed from the PlantList?
 
+	PlantStore* store;			// holds the state below once the plant is established (NULL for spacers)
+	int slot;					// position in the store, equal to the position in the PlantList
+
 	// Clonal
 	std::vector< std::shared_ptr<Plant> > growingSpacerList;	// List of growing Spacer
 	double spacerLengthToGrow;
 
 	// Constructors
-    Plant(const std::unique_ptr<Seed> & seed, ITV_mode itv); 						// from a germinated seed
-    Plant(double x, double y, const std::shared_ptr<Plant> & plant, ITV_mode itv); 	// for clonal establishment
+    Plant(const std::unique_ptr<Seed> & seed, ITV_mode itv, int aPlantID); 						// from a germinated seed
+    Plant(double x, double y, const std::shared_ptr<Plant> & plant, ITV_mode itv, int aPlantID); 	// for clonal establishment
+    Plant(const std::shared_ptr<const Traits> & aTraits, int aPlantID); 							// restored from a checkpoint
 	~Plant();
 
-    void Grow(int aWeek); 									 // shoot-root resource allocation and plant growth in two layers
-    void Kill(double);  									 // Mortality due to resource shortage or at random
+    void Kill(double, RandomGenerator&);  					 // Mortality due to resource shortage or at random
     void DecomposeDead(double);     						 // calculate mass shrinkage of dead plants
     void WinterLoss(double); 							 	 // removal of aboveground biomass in winter
 	bool stressed() const;							 // return true if plant is stressed
@@ -73,23 +68,51 @@ public:
 	void RemoveRootMass(const double mass_removed);  // removal of belowground biomass by root herbivory
 	double comp_coef(const int layer, const int symmetry) const; // competition coefficient for a plant (for AboveComp and BelowComp)
 
-	inline double minresA() const { return traits->mThres * Ash_disc * traits->Gmax; } // lower threshold of aboveground resource uptake
-	inline double minresB() const { return traits->mThres * Art_disc * traits->Gmax; } // lower threshold of belowground resource uptake
-
-	inline double GetMass() const { return mShoot + mRoot + mRepro; }
-
+	inline double minresA() const { return traits->mThres * Ash_disc() * traits->Gmax; } // lower threshold of aboveground resource uptake
+	inline double minresB() const { return traits->mThres * Art_disc() * traits->Gmax; } // lower threshold of belowground resource uptake
+
+	// State in the PlantStore
+	inline double& mShoot() { return store->mShoot[slot]; }		// shoot mass
+	inline double& mRoot() { return store->mRoot[slot]; }		// root mass
+	inline double& mRepro() { return store->mRepro[slot]; }		// reproductive mass (converted to a discrete number of seeds)
+	inline double& Auptake() { return store->Auptake[slot]; }	// uptake of above-ground resource in one time step
+	inline double& Buptake() { return store->Buptake[slot]; }	// uptake below-ground resource one time step
+	inline double mShoot() const { return store->mShoot[slot]; }
+	inline double mRoot() const { return store->mRoot[slot]; }
+	inline double mRepro() const { return store->mRepro[slot]; }
+	inline double Auptake() const { return store->Auptake[slot]; }
+	inline double Buptake() const { return store->Buptake[slot]; }
+	inline int& Ash_disc() { return store->AshDisc[slot]; }		// discrete above-ground ZOI area
+	inline int& Art_disc() { return store->ArtDisc[slot]; }		// discrete below-ground ZOI area
+	inline int& isStressed() { return store->Stress[slot]; }	// counter for weeks with resource stress exposure
+	inline int Ash_disc() const { return store->AshDisc[slot]; }
+	inline int Art_disc() const { return store->ArtDisc[slot]; }
+	inline int isStressed() const { return store->Stress[slot]; }
+	inline bool isDead() const { return store->isDead[slot]; }	// plant dead or alive?
+	inline void setDead() { store->Kill(slot); }
+
+	inline double GetMass() const { return mShoot() + mRoot() + mRepro(); }
+
+	// ZOI geometry and height, cached in the store (PlantStore::UpdateGeometry)
 	inline double getHeight(double const c_height_conversion = 6.5) const {
-		return pow(mShoot / (traits->LMR), 1 / 3.0) * c_height_conversion;
+		assert(store->GeometryShoot[slot] == mShoot());
+		return store->Height[slot] * c_height_conversion;
 	}
 
 	inline double getBiomassAtHeight(double const height, double const c_height_conversion = 6.5) const {
 		return ( (pow(height, 3) * traits->LMR) / pow(c_height_conversion, 3) );
 	}
 
-	inline double Area_shoot()		{ return traits->SLA * pow(traits->LMR * mShoot, 2.0 / 3.0); } // ZOI area
-	inline double Area_root()   	{ return traits->RAR * pow(mRoot, 2.0 / 3.0); }
-	inline double Radius_shoot() 	{ return sqrt(traits->SLA * pow(traits->LMR * mShoot, 2.0 / 3.0) / Pi); } // ZOI radius
-	inline double Radius_root() 	{ return sqrt(traits->RAR * pow(mRoot, 2.0 / 3.0) / Pi); }
+	inline double Area_shoot() const {	// ZOI area
+		assert(store->GeometryShoot[slot] == mShoot());
+		return store->AreaShoot[slot];
+	}
+	inline double Area_root() const {
+		assert(store->GeometryRoot[slot] == mRoot());
+		return store->AreaRoot[slot];
+	}
+	inline double Radius_shoot() const	{ return sqrt(Area_shoot() / Pi); } // ZOI radius
+	inline double Radius_root() const	{ return sqrt(Area_root() / Pi); }
 
 	void setCell(Cell* cell);
 	inline Cell* getCell() { return cell; }
@@ -104,15 +127,15 @@ public:
 	int GetNRamets() const;  		// return number of ramets
 
 	inline static double getPalatability(const std::shared_ptr<Plant> & p) {
-		if (p->isDead)
+		if (p->isDead())
 		{
 			return 0;
 		}
-		return p->mShoot * p->traits->GrazFraction();
+		return p->mShoot() * p->traits->GrazFraction();
 	}
 
 	inline static double getShootGeometry(const std::shared_ptr<Plant> & p) {
-		return (p->mShoot / p->traits->LMR);
+		return (p->mShoot() / p->traits->LMR);
 	}
 
 	// return if plant should be removed
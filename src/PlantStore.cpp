@@ -0,0 +1,504 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "itv_mode.h"
+#include "Plant.h"
+#include "Traits.h"
+#include "PlantStore.h"
+#include "Checkpoint.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+PlantStore::PlantStore()
+{
+
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * A plant starts with the initial mass of its PFT on the cell it established on.
+ */
+void PlantStore::Add(Plant* aPlant)
+{
+    assert(aPlant->store == NULL);
+
+    const Traits* t = aPlant->traits.get();
+
+    aPlant->store = this;
+    aPlant->slot = size();
+
+    mShoot.push_back(t->m0);
+    mRoot.push_back(t->m0);
+    mRepro.push_back(0);
+    Auptake.push_back(0);
+    Buptake.push_back(0);
+    mReproRamets.push_back(0);
+    AshDisc.push_back(0);
+    ArtDisc.push_back(0);
+    Stress.push_back(0);
+    GrazFraction.push_back(t->GrazFraction());
+    Gmax.push_back(t->Gmax);
+    CompPowerA.push_back(t->CompPowerA());
+    LMR.push_back(t->LMR);
+    SLA.push_back(t->SLA);
+    RAR.push_back(t->RAR);
+    x.push_back(aPlant->x);
+    y.push_back(aPlant->y);
+    pft.push_back(t->PFT_nr);
+    isDead.push_back(false);
+    clonal.push_back(t->clonal);
+    owner.push_back(aPlant);
+
+    Growth.push_back(t->growth);
+    AllocSeed.push_back(t->allocSeed);
+    AllocSpacer.push_back(t->allocSpacer);
+    FlowerWeek.push_back(t->flowerWeek);
+    DispersalWeek.push_back(t->dispersalWeek);
+    MThres.push_back(t->mThres);
+    ShootResp.push_back(t->growth * t->SLA * pow(t->LMR, 2.0 / 3.0) * t->Gmax);
+    RootResp.push_back(t->growth * t->Gmax * t->RAR);
+    MaxMassR.push_back(pow(t->maxMass, 4.0 / 3.0));
+
+    AreaShoot.push_back(0);
+    AreaRoot.push_back(0);
+    Height.push_back(0);
+    GeometryShoot.push_back(-1);
+    GeometryRoot.push_back(-1);
+
+    if (int(Stats.Pop.size()) <= t->PFT_nr)
+    {
+        Stats.Pop.resize(t->PFT_nr + 1, 0);
+    }
+    Stats.Pop[t->PFT_nr]++;
+
+    if (!t->clonal)
+    {
+        Stats.NPlants++;
+    }
+
+    auto genet = aPlant->getGenet().lock();
+    if (genet && genet->NLiving++ == 0)
+    {
+        Stats.NGenets++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void PlantStore::Kill(int aSlot)
+{
+    if (isDead[aSlot])
+    {
+        return;
+    }
+
+    isDead[aSlot] = true;
+
+    Stats.Pop[pft[aSlot]]--;
+
+    if (!clonal[aSlot])
+    {
+        Stats.NPlants--;
+    }
+
+    auto genet = owner[aSlot]->getGenet().lock();
+    if (genet && --genet->NLiving == 0)
+    {
+        Stats.NGenets--;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void PlantStore::moveSlot(int aFrom, int aTo)
+{
+    forEachArray(*this, [aFrom, aTo] (auto & v) { v[aTo] = v[aFrom]; });
+
+    owner[aTo]->slot = aTo;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Same order as std::remove_if on the PlantList: the remaining slots keep their sequence.
+ */
+void PlantStore::Compact()
+{
+    int n = 0;
+    for (int i = 0; i < size(); i++)
+    {
+        if (owner[i]->toBeRemoved)
+        {
+            owner[i]->store = NULL;
+            continue;
+        }
+
+        if (n != i)
+        {
+            moveSlot(i, n);
+        }
+        n++;
+    }
+
+    forEachArray(*this, [n] (auto & v) { v.resize(n); });
+}
+
+//-----------------------------------------------------------------------------
+
+template <typename T>
+static void gather(vector<T> & aValues, const vector<int> & aFrom)
+{
+    vector<T> v(aFrom.size());
+    for (unsigned int i = 0; i < aFrom.size(); i++)
+    {
+        v[i] = aValues[aFrom[i]];
+    }
+    aValues.swap(v);
+}
+
+void PlantStore::Reorder(const vector< shared_ptr<Plant> > & aPlants)
+{
+    assert(int(aPlants.size()) == size());
+
+    vector<int> from(aPlants.size());
+    for (unsigned int i = 0; i < aPlants.size(); i++)
+    {
+        from[i] = aPlants[i]->slot;
+    }
+
+    forEachArray(*this, [&from] (auto & v) { gather(v, from); });
+
+    for (int i = 0; i < size(); i++)
+    {
+        owner[i]->slot = i;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// every array of the store but the owners, which are the plants of the PlantList
+namespace
+{
+    struct ArrayWriter
+    {
+        CheckpointWriter & writer;
+
+        template <typename T>
+        void operator()(const vector<T> & aValues) { writer.Write(aValues); }
+        void operator()(const vector<Plant*> &) { }
+    };
+
+    struct ArrayReader
+    {
+        CheckpointReader & reader;
+
+        template <typename T>
+        void operator()(vector<T> & aValues) { reader.Read(aValues); }
+        void operator()(vector<Plant*> &) { }
+    };
+}
+
+/**
+ * The owners are not saved: the Grid restores the PlantList before the store.
+ */
+void PlantStore::SaveState(CheckpointWriter & aWriter) const
+{
+    forEachArray(*this, ArrayWriter{ aWriter });
+
+    aWriter.Write(Stats.Pop);
+    aWriter.Write(Stats.NPlants);
+    aWriter.Write(Stats.NGenets);
+    aWriter.Write(Stats.NSeeds);
+}
+
+//-----------------------------------------------------------------------------
+
+void PlantStore::LoadState(CheckpointReader & aReader, const vector< shared_ptr<Plant> > & aPlants)
+{
+    forEachArray(*this, ArrayReader{ aReader });
+
+    owner.resize(aPlants.size());
+    for (int i = 0; i < int(aPlants.size()); i++)
+    {
+        assert(aPlants[i]->store == NULL);
+
+        owner[i] = aPlants[i].get();
+        owner[i]->store = this;
+        owner[i]->slot = i;
+    }
+    assert(int(mShoot.size()) == size() && int(GeometryRoot.size()) == size());
+
+    aReader.Read(Stats.Pop);
+    aReader.Read(Stats.NPlants);
+    aReader.Read(Stats.NGenets);
+    aReader.Read(Stats.NSeeds);
+}
+
+//-----------------------------------------------------------------------------
+
+double PlantStore::TotalAboveMass() const
+{
+    double above_mass = 0;
+    for (int i = 0; i < size(); i++)
+    {
+        if (!isDead[i])
+        {
+            above_mass += mShoot[i] + mRepro[i];
+        }
+    }
+    return above_mass;
+}
+
+//-----------------------------------------------------------------------------
+
+double PlantStore::TotalBelowMass() const
+{
+    double below_mass = 0;
+    for (int i = 0; i < size(); i++)
+    {
+        if (!isDead[i])
+        {
+            below_mass += mRoot[i];
+        }
+    }
+    return below_mass;
+}
+
+//-----------------------------------------------------------------------------
+
+int PlantStore::NPlants() const
+{
+    int NPlants = 0;
+    for (int i = 0; i < size(); i++)
+    {
+        if (!clonal[i] && !isDead[i])
+        {
+            NPlants++;
+        }
+    }
+    return NPlants;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Growth, grazing, cutting, winter dieback and decomposition change the masses;
+ * the geometry of a slot is recomputed only if its mass differs from the one the
+ * geometry was computed for. Called before the consumers (CoverCells, Cutting, print_ind).
+ */
+void PlantStore::UpdateGeometry()
+{
+    for (int i = 0; i < size(); i++)
+    {
+        if (GeometryShoot[i] != mShoot[i])
+        {
+            AreaShoot[i] = SLA[i] * pow(LMR[i] * mShoot[i], 2.0 / 3.0);
+            Height[i] = pow(mShoot[i] / LMR[i], 1 / 3.0);
+            GeometryShoot[i] = mShoot[i];
+        }
+
+        if (GeometryRoot[i] != mRoot[i])
+        {
+            AreaRoot[i] = RAR[i] * pow(mRoot[i], 2.0 / 3.0);
+            GeometryRoot[i] = mRoot[i];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * two-layer growth of all living plants
+ * -# Resources for fecundity are allocated
+ * -# According to the resources allocated and the respiration needs
+ * shoot- and root-growth are calculated: dm/dt = growth*(c*m^p - m^q / m_max^r),
+ * with p = 2/3, q = 2, r = 4/3; the powers of the traits are constants of the slot
+ * -# Stress-value is in- or decreased according to the uptake
+ *
+ * With SSE2 two plants are processed at once; the scalar loop does the rest.
+ * Both give the same numbers (min/max keep the argument order of std::min/std::max).
+ */
+void PlantStore::Grow(int aWeek)
+{
+    const int n = size();
+
+    double* __restrict shoot = mShoot.data();
+    double* __restrict root = mRoot.data();
+    double* __restrict repro = mRepro.data();
+    double* __restrict ramets = mReproRamets.data();
+    int* __restrict stress = Stress.data();
+
+    const double* __restrict Aup = Auptake.data();
+    const double* __restrict Bup = Buptake.data();
+    const int* __restrict ash = AshDisc.data();
+    const int* __restrict art = ArtDisc.data();
+    const char* __restrict dead = isDead.data();
+
+    const double* __restrict growth = Growth.data();
+    const double* __restrict gmax = Gmax.data();
+    const double* __restrict allocSeed = AllocSeed.data();
+    const double* __restrict allocSpacer = AllocSpacer.data();
+    const int* __restrict flowerWeek = FlowerWeek.data();
+    const int* __restrict dispersalWeek = DispersalWeek.data();
+    const double* __restrict mThres = MThres.data();
+    const double* __restrict shootResp = ShootResp.data();
+    const double* __restrict rootResp = RootResp.data();
+    const double* __restrict maxMassR = MaxMassR.data();
+
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d two = _mm_set1_pd(2.0);
+    const __m128d week = _mm_set1_pd(aWeek);
+
+    for (; i + 2 <= n; i += 2)
+    {
+        // masks of the two lanes
+        const __m128d alive = _mm_cmpeq_pd(_mm_set_pd(dead[i + 1], dead[i]), zero);
+
+        const __m128d A = _mm_loadu_pd(Aup + i);
+        const __m128d B = _mm_loadu_pd(Bup + i);
+        const __m128d Ash = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) (ash + i)));
+        const __m128d Art = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) (art + i)));
+        const __m128d Growth = _mm_loadu_pd(growth + i);
+        const __m128d Gmax = _mm_loadu_pd(gmax + i);
+        const __m128d AllocSeed = _mm_loadu_pd(allocSeed + i);
+        const __m128d Shoot = _mm_loadu_pd(shoot + i);
+        const __m128d Root = _mm_loadu_pd(root + i);
+        const __m128d MaxMassR = _mm_loadu_pd(maxMassR + i);
+        const __m128d MThres = _mm_loadu_pd(mThres + i);
+
+        const __m128d LimRes = _mm_min_pd(A, B);
+
+        const __m128d reproducing = _mm_cmple_pd(_mm_loadu_pd(repro + i), _mm_mul_pd(AllocSeed, Shoot));
+        const __m128d seeding = _mm_and_pd(
+                _mm_cmpge_pd(week, _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) (flowerWeek + i)))),
+                _mm_cmplt_pd(week, _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) (dispersalWeek + i)))));
+
+        const __m128d SeedRes = _mm_mul_pd(LimRes, AllocSeed);
+        const __m128d SpacerRes = _mm_mul_pd(LimRes, _mm_loadu_pd(allocSpacer + i));
+
+        const __m128d d = _mm_max_pd(_mm_min_pd(_mm_sub_pd(LimRes, SeedRes), SpacerRes), zero);
+        const __m128d RametRes = _mm_or_pd(_mm_and_pd(seeding, d), _mm_andnot_pd(seeding, SpacerRes));
+
+        const __m128d dm_seeds = _mm_and_pd(_mm_and_pd(alive, _mm_and_pd(reproducing, seeding)),
+                _mm_max_pd(_mm_mul_pd(Growth, SeedRes), zero));
+        const __m128d dm_ramets = _mm_and_pd(_mm_and_pd(alive, reproducing),
+                _mm_max_pd(_mm_mul_pd(Growth, RametRes), zero));
+
+        const __m128d VegRepro = _mm_sub_pd(_mm_sub_pd(LimRes, _mm_and_pd(seeding, SeedRes)), RametRes);
+        const __m128d VegRes = _mm_or_pd(_mm_and_pd(reproducing, VegRepro), _mm_andnot_pd(reproducing, LimRes));
+
+        const __m128d alloc_shoot = _mm_div_pd(B, _mm_add_pd(B, A));
+
+        const __m128d ShootRes = _mm_mul_pd(alloc_shoot, VegRes);
+        const __m128d RootRes = _mm_sub_pd(VegRes, ShootRes);
+
+        const __m128d Assim_shoot = _mm_mul_pd(Growth, _mm_min_pd(_mm_mul_pd(Gmax, Ash), ShootRes));
+        const __m128d Resp_shoot = _mm_div_pd(_mm_mul_pd(_mm_loadu_pd(shootResp + i), _mm_mul_pd(Shoot, Shoot)), MaxMassR);
+
+        const __m128d Assim_root = _mm_mul_pd(Growth, _mm_min_pd(_mm_mul_pd(Gmax, Art), RootRes));
+        const __m128d Resp_root = _mm_div_pd(_mm_mul_pd(_mm_loadu_pd(rootResp + i), _mm_mul_pd(Root, Root)), MaxMassR);
+
+        const __m128d dm_shoot = _mm_and_pd(alive, _mm_max_pd(_mm_sub_pd(Assim_shoot, Resp_shoot), zero));
+        const __m128d dm_root = _mm_and_pd(alive, _mm_max_pd(_mm_sub_pd(Assim_root, Resp_root), zero));
+
+        const __m128d stressed = _mm_or_pd(
+                _mm_cmplt_pd(_mm_div_pd(A, two), _mm_mul_pd(_mm_mul_pd(MThres, Ash), Gmax)),
+                _mm_cmplt_pd(_mm_div_pd(B, two), _mm_mul_pd(_mm_mul_pd(MThres, Art), Gmax)));
+
+        _mm_storeu_pd(repro + i, _mm_add_pd(_mm_loadu_pd(repro + i), dm_seeds));
+        _mm_storeu_pd(ramets + i, _mm_add_pd(_mm_loadu_pd(ramets + i), dm_ramets));
+        _mm_storeu_pd(shoot + i, _mm_add_pd(Shoot, dm_shoot));
+        _mm_storeu_pd(root + i, _mm_add_pd(Root, dm_root));
+
+        const int aliveBits = _mm_movemask_pd(alive);
+        const int stressedBits = _mm_movemask_pd(stressed);
+        for (int k = 0; k < 2; k++)
+        {
+            if (aliveBits & (1 << k))
+            {
+                if (stressedBits & (1 << k))
+                {
+                    ++stress[i + k];
+                }
+                else if (stress[i + k] > 0)
+                {
+                    --stress[i + k];
+                }
+            }
+        }
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        if (dead[i])
+        {
+            continue;
+        }
+
+        const double A = Aup[i];
+        const double B = Bup[i];
+
+        // which resource is limiting growth?
+        const double LimRes = min(B, A); // two layers
+
+        // 1. reproduction, while the seed mass is small enough
+        double VegRes = LimRes;
+        if (repro[i] <= allocSeed[i] * shoot[i])
+        {
+            const double SeedRes = LimRes * allocSeed[i];
+            const double SpacerRes = LimRes * allocSpacer[i];
+
+            if (aWeek >= flowerWeek[i] && aWeek < dispersalWeek[i])
+            {
+                repro[i] += max(0.0, growth[i] * SeedRes);
+
+                // for large AllocSeed, resources may be < SpacerRes, then only take remaining resources
+                const double d = max(0.0, min(SpacerRes, LimRes - SeedRes));
+                ramets[i] += max(0.0, growth[i] * d);
+
+                VegRes = LimRes - SeedRes - d;
+            }
+            else
+            {
+                ramets[i] += max(0.0, growth[i] * SpacerRes);
+
+                VegRes = LimRes - SpacerRes;
+            }
+        }
+
+        // 2. allocation to shoot and root growth
+        const double alloc_shoot = B / (B + A); // allocation coefficient
+
+        const double ShootRes = alloc_shoot * VegRes;
+        const double RootRes = VegRes - ShootRes;
+
+        // growth limited by maximal resource per area -> similar to uptake limitation;
+        // respiration proportional to the squared mass
+        const double Assim_shoot = growth[i] * min(ShootRes, gmax[i] * ash[i]);
+        const double Resp_shoot = shootResp[i] * (shoot[i] * shoot[i]) / maxMassR[i];
+
+        const double Assim_root = growth[i] * min(RootRes, gmax[i] * art[i]);
+        const double Resp_root = rootResp[i] * (root[i] * root[i]) / maxMassR[i];
+
+        shoot[i] += max(0.0, Assim_shoot - Resp_shoot);
+        root[i] += max(0.0, Assim_root - Resp_root);
+
+        // 3. stress
+        if ((A / 2.0 < mThres[i] * ash[i] * gmax[i]) || (B / 2.0 < mThres[i] * art[i] * gmax[i]))
+        {
+            ++stress[i];
+        }
+        else if (stress[i] > 0)
+        {
+            --stress[i];
+        }
+    }
+}
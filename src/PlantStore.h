@@ -0,0 +1,122 @@
+#ifndef SRC_PLANTSTORE_H_
+#define SRC_PLANTSTORE_H_
+
+#include <vector>
+#include <memory>
+
+class Plant;
+class CheckpointWriter;
+class CheckpointReader;
+
+//! Running counts of the population
+/*! The PlantStore updates the plant counts when a plant is established or dies,
+ the Grid the seed count whenever seeds are added to or leave the seed banks.
+ Reporting and the exit conditions read them instead of scanning plants, genets and cells.
+ */
+struct PopulationStats
+{
+    std::vector<int> Pop;               // living plants per PFT number
+    int NPlants;                        // living non-clonal plants
+    int NGenets;                        // genets with at least one living ramet
+    int NSeeds;                         // seeds in the seed banks of all cells
+
+    PopulationStats() : NPlants(0), NGenets(0), NSeeds(0) {}
+};
+
+//! State of all established plants as parallel arrays (structure of arrays)
+/*! Slot i of every array belongs to the i-th plant of Grid::PlantList, so the weekly passes
+ over the population are linear scans over a few contiguous arrays instead of two pointer
+ dereferences per plant. The Plant objects stay the stable handles that genets, spacers and
+ the output refer to; a plant reads and writes its slot through its accessors (Plant::mShoot() ...).
+
+ Slots are appended when a plant is established, compacted in order when plants are removed
+ and reordered whenever the PlantList is reordered, so both sequences always match.
+ */
+class PlantStore
+{
+
+public:
+    std::vector<double> mShoot;         // shoot mass
+    std::vector<double> mRoot;          // root mass
+    std::vector<double> mRepro;         // reproductive mass
+    std::vector<double> Auptake;        // uptake of above-ground resource this week
+    std::vector<double> Buptake;        // uptake of below-ground resource this week
+    std::vector<double> mReproRamets;   // resources for ramet growth
+    std::vector<int> AshDisc;           // discrete above-ground ZOI area
+    std::vector<int> ArtDisc;           // discrete below-ground ZOI area
+    std::vector<int> Stress;            // counter for weeks with resource stress exposure
+    std::vector<double> GrazFraction;   // constant trait: palatability per shoot mass
+    std::vector<double> Gmax;           // constant trait: maximal resource utilization
+    std::vector<double> CompPowerA;     // constant trait: aboveground competitive power per shoot mass
+    std::vector<double> LMR;            // constant trait: leaf mass ratio
+    std::vector<double> SLA;            // constant trait: specific leaf area
+    std::vector<double> RAR;            // constant trait: root area ratio
+    std::vector<int> x;                 // cell of the plant
+    std::vector<int> y;
+    std::vector<int> pft;               // Traits::PFT_nr
+    std::vector<char> isDead;           // char instead of bool: std::vector<bool> is not an array
+    std::vector<char> clonal;           // constant trait
+    std::vector<Plant*> owner;          // handle of the slot
+
+    // constants of the growth function, from the traits of the plant
+    std::vector<double> Growth;         // conversion rate of resource to biomass
+    std::vector<double> AllocSeed;
+    std::vector<double> AllocSpacer;
+    std::vector<int> FlowerWeek;
+    std::vector<int> DispersalWeek;
+    std::vector<double> MThres;         // stress threshold of the uptake per ZOI area and Gmax
+    std::vector<double> ShootResp;      // growth * SLA * LMR^(2/3) * Gmax
+    std::vector<double> RootResp;       // growth * Gmax * RAR
+    std::vector<double> MaxMassR;       // maxMass^(4/3)
+
+    // ZOI geometry, valid for the masses it was computed for (see UpdateGeometry)
+    std::vector<double> AreaShoot;      // SLA * (LMR * mShoot)^(2/3)
+    std::vector<double> AreaRoot;       // RAR * mRoot^(2/3)
+    std::vector<double> Height;         // (mShoot / LMR)^(1/3), times the height conversion
+    std::vector<double> GeometryShoot;  // mShoot of the geometry, -1 for none
+    std::vector<double> GeometryRoot;   // mRoot of the geometry, -1 for none
+
+    PopulationStats Stats;
+
+    PlantStore();
+
+    inline int size() const { return int(owner.size()); }
+
+    void Add(Plant* aPlant);            // appends a slot for a newly established plant
+    void Kill(int aSlot);               // marks the plant of the slot dead
+    void Compact();                     // drops the slots of all plants marked toBeRemoved
+    void Reorder(const std::vector< std::shared_ptr<Plant> > & aPlants);  // slots follow the order of aPlants
+
+    void Grow(int aWeek);               // weekly growth of all living plants
+    void UpdateGeometry();              // recomputes the geometry of the slots whose mass has changed
+
+    void SaveState(CheckpointWriter & aWriter) const;  // all arrays and the statistics
+    void LoadState(CheckpointReader & aReader, const std::vector< std::shared_ptr<Plant> > & aPlants);
+
+    double TotalAboveMass() const;      // of living plants
+    double TotalBelowMass() const;
+    int NPlants() const;                // living non-clonal plants, counted (see Stats)
+
+private:
+    void moveSlot(int aFrom, int aTo);
+
+    // applies aFunction to every array of aStore (a PlantStore or a const PlantStore)
+    template <typename Store, typename Function>
+    static void forEachArray(Store & aStore, Function aFunction)
+    {
+        aFunction(aStore.mShoot); aFunction(aStore.mRoot); aFunction(aStore.mRepro);
+        aFunction(aStore.Auptake); aFunction(aStore.Buptake);
+        aFunction(aStore.mReproRamets); aFunction(aStore.AshDisc); aFunction(aStore.ArtDisc); aFunction(aStore.Stress);
+        aFunction(aStore.GrazFraction); aFunction(aStore.Gmax); aFunction(aStore.CompPowerA); aFunction(aStore.LMR);
+        aFunction(aStore.SLA); aFunction(aStore.RAR);
+        aFunction(aStore.x); aFunction(aStore.y); aFunction(aStore.pft); aFunction(aStore.isDead);
+        aFunction(aStore.clonal); aFunction(aStore.owner);
+        aFunction(aStore.Growth); aFunction(aStore.AllocSeed); aFunction(aStore.AllocSpacer);
+        aFunction(aStore.FlowerWeek); aFunction(aStore.DispersalWeek); aFunction(aStore.MThres);
+        aFunction(aStore.ShootResp); aFunction(aStore.RootResp); aFunction(aStore.MaxMassR);
+        aFunction(aStore.AreaShoot); aFunction(aStore.AreaRoot); aFunction(aStore.Height);
+        aFunction(aStore.GeometryShoot); aFunction(aStore.GeometryRoot);
+    }
+};
+
+#endif
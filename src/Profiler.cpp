@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <sstream>
+
+#include "Profiler.h"
+#include "Checkpoint.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+Profiler::Profiler() : Enabled(false)
+{
+    Reset();
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::Reset()
+{
+    YearTime.assign(NPhases, Duration::zero());
+    YearCount.assign(NCounters, 0);
+    RunTime.assign(NPhases, Duration::zero());
+    RunCount.assign(NCounters, 0);
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::EndYear()
+{
+    for (int i = 0; i < NPhases; i++)
+    {
+        RunTime[i] += YearTime[i];
+        YearTime[i] = Duration::zero();
+    }
+
+    for (int i = 0; i < NCounters; i++)
+    {
+        RunCount[i] += YearCount[i];
+        YearCount[i] = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::SaveState(CheckpointWriter & aWriter) const
+{
+    for (auto const* times : { &YearTime, &RunTime })
+    {
+        for (auto const& t : *times)
+        {
+            aWriter.Write(int64_t(t.count()));
+        }
+    }
+    aWriter.Write(YearCount);
+    aWriter.Write(RunCount);
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler::LoadState(CheckpointReader & aReader)
+{
+    for (auto* times : { &YearTime, &RunTime })
+    {
+        for (auto& t : *times)
+        {
+            t = Duration(aReader.Read<int64_t>());
+        }
+    }
+    aReader.Read(YearCount);
+    aReader.Read(RunCount);
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Seconds per phase, then the counters. Plants and covered entries are given
+ * as means per week.
+ */
+vector<string> Profiler::Header()
+{
+    return { "ResetWeeklyVariables", "SetCellResources", "CoverCells", "DistributeResource",
+             "PlantLoop", "Disturb", "RemovePlants", "EstablishmentLottery", "Seasonal", "Output",
+             "Weeks", "Plants", "CoveredEntries", "SeedsDispersed", "SeedsGerminated" };
+}
+
+//-----------------------------------------------------------------------------
+
+string Profiler::row(const vector<Duration> & aTime, const vector<long> & aCount)
+{
+    std::ostringstream ss;
+
+    for (auto const& t : aTime)
+    {
+        ss << chrono::duration<double>(t).count() << ", ";
+    }
+
+    const double weeks = max(1L, aCount[Weeks]);
+
+    ss << aCount[Weeks]                     << ", ";
+    ss << aCount[Plants] / weeks            << ", ";
+    ss << aCount[CoveredEntries] / weeks    << ", ";
+    ss << aCount[SeedsDispersed]            << ", ";
+    ss << aCount[SeedsGerminated];
+
+    return ss.str();
+}
+
+//-----------------------------------------------------------------------------
+
+string Profiler::YearRow() const
+{
+    return row(YearTime, YearCount);
+}
+
+//-----------------------------------------------------------------------------
+
+string Profiler::RunRow() const
+{
+    return row(RunTime, RunCount);
+}
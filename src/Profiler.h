@@ -0,0 +1,95 @@
+#ifndef SRC_PROFILER_H_
+#define SRC_PROFILER_H_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+class CheckpointWriter;
+class CheckpointReader;
+
+//! Wall clock time and work counters of the phases of a simulated week
+/*! The phases of GridEnvir::OneWeek() are timed by scoped timers (Profiler::Scope); the
+ counters record how much work the week had. Time and counts are summed per year and per run,
+ and GridEnvir writes them as rows of the profile file.
+ While the profiler is disabled, a scope and a count cost a single test.
+ */
+class Profiler
+{
+
+public:
+    enum Phase
+    {
+        ResetWeeklyVariables,
+        SetCellResources,
+        CoverCells,
+        DistributeResource,
+        PlantLoop,
+        Disturb,
+        RemovePlants,
+        EstablishmentLottery,
+        Seasonal,               // seed rain, seed mortality, winter, catastrophic disturbance
+        Output,                 // statistics, output rows and exit conditions
+        NPhases
+    };
+
+    enum Counter
+    {
+        Weeks,
+        Plants,                 // plants in the PlantList, summed over the weeks
+        CoveredEntries,         // plant-cell pairs of the ZOIs (above- and belowground), summed over the weeks
+        SeedsDispersed,
+        SeedsGerminated,
+        NCounters
+    };
+
+    //! Adds the time from its construction to its destruction to a phase
+    class Scope
+    {
+    public:
+        inline Scope(Profiler & aProfiler, Phase aPhase) : profiler(aProfiler), phase(aPhase)
+        {
+            if (profiler.Enabled)
+                start = std::chrono::steady_clock::now();
+        }
+
+        inline ~Scope()
+        {
+            if (profiler.Enabled)
+                profiler.YearTime[phase] += std::chrono::steady_clock::now() - start;
+        }
+
+    private:
+        Profiler & profiler;
+        Phase phase;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    bool Enabled;
+
+    Profiler();
+
+    inline void Count(Counter aCounter, long aN) { if (Enabled) YearCount[aCounter] += aN; }
+
+    void EndYear();                     // adds the year to the run and starts a new year
+    void Reset();
+
+    void SaveState(CheckpointWriter & aWriter) const;  // the sums of the current year and run
+    void LoadState(CheckpointReader & aReader);
+
+    static std::vector<std::string> Header();
+    std::string YearRow() const;        // the current year, without the leading ID columns
+    std::string RunRow() const;         // all completed years
+
+private:
+    typedef std::chrono::steady_clock::duration Duration;
+
+    std::vector<Duration> YearTime;
+    std::vector<long> YearCount;
+    std::vector<Duration> RunTime;
+    std::vector<long> RunCount;
+
+    static std::string row(const std::vector<Duration> & aTime, const std::vector<long> & aCount);
+};
+
+#endif
@@ -1,20 +1,203 @@
 #include <random>
+#include <cstdint>
+#include <cmath>
+#include <sstream>
 
+#include "itv_mode.h"
 #include "RandomGenerator.h"
+#include "Checkpoint.h"
+
+/*
+ * SplitMix64: every call advances the state by a constant and returns a strongly mixed
+ * value of it. Good for turning a few correlated integers into unrelated seeds.
+ */
+static uint64_t splitmix64(uint64_t & aState)
+{
+    uint64_t z = (aState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ * The start seed and the identity of the run are hashed one after the other into a key,
+ * which is expanded into the whole state of the engine. The stream of a run therefore only
+ * depends on (start seed, SimID, ComNr, RunNr), not on the order or the thread the runs are
+ * executed in, and runs that differ in any of them get unrelated streams.
+ */
+void RandomGenerator::seed(unsigned int aStartSeed, int aSimID, int aComNr, int aRunNr, rngBackend aBackend)
+{
+    Backend = aBackend;
+
+    uint64_t state = aStartSeed;
+    uint64_t key = splitmix64(state);
+
+    for (int id : { aSimID, aComNr, aRunNr })
+    {
+        state = key ^ uint32_t(id);
+        key = splitmix64(state);
+    }
+
+    state = key;
+    uint32_t words[8];
+    for (int i = 0; i < 8; i += 2)
+    {
+        uint64_t w = splitmix64(state);
+        words[i] = uint32_t(w);
+        words[i + 1] = uint32_t(w >> 32);
+    }
+
+    std::seed_seq sequence(words, words + 8);
+    rng.seed(sequence);
+
+    for (int i = 0; i < 4; i++)
+    {
+        Xoshiro.s[i] = splitmix64(state);   // never all zero
+    }
+
+    Uniform01.reset();
+    Normal.reset();
+    HasSpare = false;
+}
 
 int RandomGenerator::getUniformInt(int thru)
 {
 	return floor(get01() * thru);
 }
 
-double RandomGenerator::get01()
+/*
+ * Standard normal numbers of the xoshiro256 backend by the Box-Muller transform, which,
+ * unlike the polar method, needs no rejection: two uniforms give two normals.
+ */
+double RandomGenerator::nextGaussian()
 {
-	std::uniform_real_distribution<double> dist(0, 1);
-	return dist(rng);
+    if (HasSpare)
+    {
+        HasSpare = false;
+        return Spare;
+    }
+
+    const double r = std::sqrt(-2.0 * std::log(1.0 - get01()));  // 1 - u in (0, 1]
+    const double phi = 2 * M_PI * get01();
+
+    Spare = r * std::sin(phi);
+    HasSpare = true;
+
+    return r * std::cos(phi);
 }
 
 double RandomGenerator::getGaussian(double mean, double sd)
 {
-	std::normal_distribution<double> dist(mean, sd);
-	return dist(rng);
+    if (Backend == xoshiro256)
+        return mean + sd * nextGaussian();
+
+    return Normal(rng, std::normal_distribution<double>::param_type(mean, sd));
+}
+
+int RandomGenerator::getBinomial(int n, double p)
+{
+    std::binomial_distribution<int> dist(n, p);
+
+    if (Backend == xoshiro256)
+        return dist(Xoshiro);
+
+    return dist(rng);
+}
+
+void RandomGenerator::fill01(double* aOut, int aN)
+{
+    if (Backend == xoshiro256)
+    {
+        Xoshiro256 engine = Xoshiro;    // local copy: the state can stay in registers
+        for (int i = 0; i < aN; i++)
+        {
+            aOut[i] = toUnit(engine());
+        }
+        Xoshiro = engine;
+    }
+    else
+    {
+        for (int i = 0; i < aN; i++)
+        {
+            aOut[i] = Uniform01(rng);
+        }
+    }
+}
+
+/*
+ * xoshiro256: uniforms for all pairs at once, then the transform in a loop without
+ * branches or calls into the engine.
+ */
+void RandomGenerator::fillGaussian(double* aOut, int aN, double aMean, double aSd)
+{
+    if (Backend != xoshiro256)
+    {
+        for (int i = 0; i < aN; i++)
+        {
+            aOut[i] = getGaussian(aMean, aSd);
+        }
+        return;
+    }
+
+    int i = 0;
+    if (HasSpare && aN > 0)
+    {
+        aOut[i++] = aMean + aSd * nextGaussian();
+    }
+
+    const int pairs = (aN - i) / 2;
+    fill01(aOut + i, 2 * pairs);
+
+    for (int k = 0; k < pairs; k++, i += 2)
+    {
+        const double r = std::sqrt(-2.0 * std::log(1.0 - aOut[i]));
+        const double phi = 2 * M_PI * aOut[i + 1];
+
+        aOut[i] = aMean + aSd * (r * std::cos(phi));
+        aOut[i + 1] = aMean + aSd * (r * std::sin(phi));
+    }
+
+    if (i < aN)
+    {
+        aOut[i] = aMean + aSd * nextGaussian();
+    }
+}
+
+/*
+ * The standard engines and distributions have no binary state, they are saved in their
+ * text form, which restores them exactly.
+ */
+void RandomGenerator::SaveState(CheckpointWriter & aWriter) const
+{
+    std::ostringstream ss;
+    ss << rng << ' ' << Uniform01 << ' ' << Normal;
+
+    aWriter.Write(ss.str());
+    aWriter.Write(int32_t(Backend));
+    aWriter.Write(Xoshiro);
+    aWriter.Write(HasSpare);
+    aWriter.Write(Spare);
+}
+
+void RandomGenerator::LoadState(CheckpointReader & aReader)
+{
+    std::istringstream ss(aReader.Read<std::string>());
+    ss >> rng >> Uniform01 >> Normal;
+
+    Backend = rngBackend(aReader.Read<int32_t>());
+    aReader.Read(Xoshiro);
+    aReader.Read(HasSpare);
+    aReader.Read(Spare);
+}
+
+const double* RandomGenerator::get01Batch(int aN)
+{
+    if (int(Batch.size()) < aN)
+    {
+        Batch.resize(aN);
+    }
+
+    fill01(Batch.data(), aN);
+
+    return Batch.data();
 }
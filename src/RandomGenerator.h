@@ -2,6 +2,45 @@
 #define SRC_RANDOMGENERATOR_H_
 
 #include <random>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "Parameters.h"
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// xoshiro256++ (Blackman & Vigna): 256 bits of state, a few shifts and adds per number
+class Xoshiro256
+{
+
+public:
+    typedef uint64_t result_type;
+
+    uint64_t s[4];
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    inline result_type operator()()
+    {
+        const uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        const uint64_t t = s[1] << 17;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+
+        return result;
+    }
+
+private:
+    static inline uint64_t rotl(const uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
 
 class RandomGenerator
 {
@@ -9,14 +48,55 @@ class RandomGenerator
 public:
 	std::mt19937 rng;
 
+private:
+    rngBackend Backend;
+    Xoshiro256 Xoshiro;
+
+    // distributions keep their state between draws (the normal distribution produces pairs)
+    std::uniform_real_distribution<double> Uniform01;
+    std::normal_distribution<double> Normal;
+
+    // second value of the last Box-Muller pair (xoshiro256)
+    bool HasSpare;
+    double Spare;
+
+    std::vector<double> Batch;
+
+    // the upper 53 bits as a double in [0, 1)
+    static inline double toUnit(uint64_t x) { return (x >> 11) * (1.0 / 9007199254740992.0); }
+
+    double nextGaussian();
+
+public:
+
 	int getUniformInt(int thru);
-	double get01();
 	double getGaussian(double mean, double sd);
+	int getBinomial(int n, double p);
+
+    inline double get01() { return (Backend == xoshiro256) ? toUnit(Xoshiro()) : Uniform01(rng); }
+
+    // batches give the same numbers as the same number of single draws, in this order
+    void fill01(double* aOut, int aN);
+    void fillGaussian(double* aOut, int aN, double aMean, double aSd);
+    const double* get01Batch(int aN);   // valid until the next batch
 
-	RandomGenerator() : rng(std::random_device()()) {}
+    RandomGenerator() : rng(std::random_device()()), Backend(mersenneTwister), HasSpare(false), Spare(0) {}
 
-    inline std::mt19937 getRNG() { return rng; }
+    template <typename Iterator>
+    void shuffle(Iterator aFirst, Iterator aLast)
+    {
+        if (Backend == xoshiro256)
+            std::shuffle(aFirst, aLast, Xoshiro);
+        else
+            std::shuffle(aFirst, aLast, rng);
+    }
+
+    // independent, reproducible stream of one run, derived from the start seed and the run's identity
+    void seed(unsigned int aStartSeed, int aSimID, int aComNr, int aRunNr, rngBackend aBackend = mersenneTwister);
+
+    // the position in the stream, engines and distributions (checkpoints)
+    void SaveState(CheckpointWriter & aWriter) const;
+    void LoadState(CheckpointReader & aReader);
 };
 
 #endif /* SRC_RANDOMGENERATOR_H_ */
-
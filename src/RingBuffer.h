@@ -0,0 +1,94 @@
+#ifndef SRC_RINGBUFFER_H_
+#define SRC_RINGBUFFER_H_
+
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+//! The last Capacity values of a series, with their running sum
+/*! push_back overwrites the oldest value once the buffer is full, so the memory is bounded by
+ the capacity however long the run is. The sum is kept in the type Sum and updated by each
+ push_back (exact for integer types); element 0 is the oldest value.
+ */
+template <typename T, typename Sum = T>
+class RingBuffer
+{
+
+private:
+    std::vector<T> Data;
+    int Capacity;
+    int First;      // position of the oldest value
+    int Count;
+    Sum Total;
+
+public:
+    RingBuffer(int aCapacity = 1) : Capacity(0), First(0), Count(0), Total(0)
+    {
+        SetCapacity(aCapacity);
+    }
+
+    // discards the values
+    void SetCapacity(int aCapacity)
+    {
+        assert(aCapacity >= 1);
+
+        Capacity = aCapacity;
+        Data.assign(Capacity, T());
+        clear();
+    }
+
+    void clear()
+    {
+        First = 0;
+        Count = 0;
+        Total = 0;
+    }
+
+    void push_back(const T & aValue)
+    {
+        if (Count < Capacity)
+        {
+            Data[(First + Count) % Capacity] = aValue;
+            Count++;
+        }
+        else
+        {
+            Total -= Data[First];
+            Data[First] = aValue;
+            First = (First + 1) % Capacity;
+        }
+        Total += aValue;
+    }
+
+    inline int size() const { return Count; }
+    inline int capacity() const { return Capacity; }
+    inline bool empty() const { return Count == 0; }
+    inline Sum sum() const { return Total; }
+
+    inline const T & operator[](int aIndex) const { return Data[(First + aIndex) % Capacity]; }
+    inline const T & back() const { return (*this)[Count - 1]; }
+
+    // capacity and values, oldest first (CheckpointWriter, CheckpointReader)
+    template <typename Writer>
+    void SaveState(Writer & aWriter) const
+    {
+        aWriter.Write(int32_t(Capacity));
+        aWriter.Write(int32_t(Count));
+        for (int i = 0; i < Count; i++)
+        {
+            aWriter.Write((*this)[i]);
+        }
+    }
+
+    template <typename Reader>
+    void LoadState(Reader & aReader)
+    {
+        SetCapacity(aReader.template Read<int32_t>());
+        for (int n = aReader.template Read<int32_t>(); n > 0; n--)
+        {
+            push_back(aReader.template Read<T>());
+        }
+    }
+};
+
+#endif
@@ -16,14 +16,16 @@ using namespace std;
 /*
  * Constructor for normal reproduction
  */
-Seed::Seed(const unique_ptr<Traits> & t, Cell* _cell, ITV_mode itv, double aSD) :
+Seed::Seed(const shared_ptr<const Traits> & t, Cell* _cell, ITV_mode itv, double aSD, RandomGenerator& aRng) :
 		cell(NULL),
 		age(0), toBeRemoved(false)
 {
-    traits = make_unique<Traits>(*t);
-
     if (itv == on) {
-        traits->varyTraits(aSD);
+        auto individual = make_shared<Traits>(*t);
+        individual->varyTraits(aSD, aRng);
+        traits = individual;
+	} else {
+        traits = t;
 	}
 
 	pEstab = traits->pEstab;
@@ -38,14 +40,16 @@ Seed::Seed(const unique_ptr<Traits> & t, Cell* _cell, ITV_mode itv, double aSD)
 /*
  * Constructor for initial establishment (with germination pre-set)
  */
-Seed::Seed(const unique_ptr<Traits> & t, Cell*_cell, double new_estab, ITV_mode itv, double aSD) :
+Seed::Seed(const shared_ptr<const Traits> & t, Cell*_cell, double new_estab, ITV_mode itv, double aSD, RandomGenerator& aRng) :
 		cell(NULL),
 		age(0), toBeRemoved(false)
 {
-    traits = make_unique<Traits>(*t);
-
     if (itv == on) {
-        traits->varyTraits(aSD);
+        auto individual = make_shared<Traits>(*t);
+        individual->varyTraits(aSD, aRng);
+        traits = individual;
+	} else {
+        traits = t;
 	}
 
 	pEstab = new_estab;
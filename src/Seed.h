@@ -7,6 +7,7 @@
 class Cell;
 class Plant;
 class Traits;
+class RandomGenerator;
 
 class Seed
 {
@@ -14,15 +15,15 @@ class Seed
        Cell* cell;
 
     public:
-       std::unique_ptr<Traits> traits;
+       std::shared_ptr<const Traits> traits;     // shared PFT trait set, or an own set under ITV
 
        double mass;
        double pEstab;
        int age;
        bool toBeRemoved;
 
-       Seed(const std::unique_ptr<Traits> & t, Cell* cell, ITV_mode itv, double aSD);
-       Seed(const std::unique_ptr<Traits> & t, Cell* cell, const double estab, ITV_mode itv, double aSD);
+       Seed(const std::shared_ptr<const Traits> & t, Cell* cell, ITV_mode itv, double aSD, RandomGenerator& aRng);
+       Seed(const std::shared_ptr<const Traits> & t, Cell* cell, const double estab, ITV_mode itv, double aSD, RandomGenerator& aRng);
 
        Cell* getCell() { return cell; }
 
@@ -31,4 +32,18 @@ class Seed
        };
 };
 
+/*
+ * Seeds of one PFT with the same age and establishment probability in one cell.
+ * Without intraspecific trait variation such seeds are indistinguishable, so the
+ * seed bank only counts them (Cell::SeedCohortList).
+ */
+struct SeedCohort
+{
+       int pft;          // Traits::PFT_nr
+       double pEstab;
+       double mass;      // mass of one seed
+       int age;
+       int count;
+};
+
 #endif
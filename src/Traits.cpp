@@ -10,8 +10,7 @@
 #include "Environment.h"
 
 #include "RandomGenerator.h"
-#include "Output.h"
-#include "IBC-grass.h"
+#include "Checkpoint.h"
 
 using namespace std;
 
@@ -19,7 +18,7 @@ using namespace std;
  * Default constructor
  */
 Traits::Traits() :
-        myTraitType(Traits::species), PFT_ID("EMPTY"),
+        myTraitType(Traits::species), PFT_ID("EMPTY"), PFT_nr(-1),
         LMR(-1), SLA(-1), RAR(1), m0(-1), maxMass(-1),
         allocSeed(0.05), seedMass(-1), dispersalDist(-1), dormancy(1), pEstab(0.5),
         Gmax(-1), palat(-1), memory(-1),
@@ -34,7 +33,7 @@ Traits::Traits() :
  * Copy constructor
  */
 Traits::Traits(const Traits& s) :
-        myTraitType(s.myTraitType), PFT_ID(s.PFT_ID),
+        myTraitType(s.myTraitType), PFT_ID(s.PFT_ID), PFT_nr(s.PFT_nr),
         LMR(s.LMR), SLA(s.SLA), RAR(s.RAR), m0(s.m0), maxMass(s.maxMass),
         allocSeed(s.allocSeed), seedMass(s.seedMass), dispersalDist(s.dispersalDist), dormancy(s.dormancy), pEstab(s.pEstab),
         Gmax(s.Gmax), palat(s.palat), memory(s.memory),
@@ -46,23 +45,15 @@ Traits::Traits(const Traits& s) :
 }
 
 /**
- * Retrieve a deep-copy of that PFT's basic trait set
+ * Retrieve the shared trait set of that PFT
  */
-unique_ptr<Traits> Traits::createTraitSetFromPftType(string type)
+const shared_ptr<const Traits> & TraitTable::getTraitSet(const string& type) const
 {
     const auto pos = pftTraitTemplates.find(type);
 
     assert(pos != pftTraitTemplates.end() && "Trait type not found");
 
-    return (make_unique<Traits>(*pos->second));
-}
-
-/**
- * Retrieve a deep-copy some arbitrary trait set (for plants dropping seeds)
- */
-unique_ptr<Traits> Traits::copyTraitSet(const unique_ptr<Traits> & t)
-{
-    return (make_unique<Traits>(*t));
+    return pos->second;
 }
 
 //-----------------------------------------------------------------------------
@@ -70,11 +61,13 @@ unique_ptr<Traits> Traits::copyTraitSet(const unique_ptr<Traits> & t)
  * Read definition of PFTs used in the simulation
  * @param file file containing PFT definitions
  */
-void Traits::ReadPFTDef(const string& file)
+void TraitTable::ReadPFTDef(const string& file)
 {
     //Open InitFile
     ifstream InitFile(file.c_str());
 
+    map< string, unique_ptr<Traits> > pfts;
+
     string line;
     getline(InitFile, line); // skip header line
     while (getline(InitFile, line))
@@ -92,9 +85,20 @@ void Traits::ReadPFTDef(const string& file)
                 >> traits->meanSpacerlength >> traits->sdSpacerlength >> traits->resourceShare
                 >> traits->allocSpacer >> traits->mSpacer;
 
-        Traits::pftInsertionOrder.push_back(traits->PFT_ID);
+        pftInsertionOrder.push_back(traits->PFT_ID);
 
-        Traits::pftTraitTemplates.insert(std::make_pair(traits->PFT_ID, std::move(traits)));
+        pfts.insert(std::make_pair(traits->PFT_ID, std::move(traits)));
+    }
+
+    // The trait sets are immutable from here on
+    for (auto& it : pfts)
+    {
+        it.second->PFT_nr = pftByNr.size();
+
+        shared_ptr<const Traits> traits(std::move(it.second));
+
+        pftByNr.push_back(traits);
+        pftTraitTemplates.insert(std::make_pair(it.first, traits));
     }
 }
 
@@ -105,7 +109,7 @@ void Traits::ReadPFTDef(const string& file)
  * distribution balanced. Other, trait-specific, requirements are checked as well. (e.g.,
  * LMR cannot be greater than 1, memory cannot be less than 1).
  */
-void Traits::varyTraits(double aSD)
+void Traits::varyTraits(double aSD, RandomGenerator& aRng)
 {
 
     assert(myTraitType == Traits::species);
@@ -116,7 +120,7 @@ void Traits::varyTraits(double aSD)
     double LMR_;
     do
     {
-        dev = rng.getGaussian(0, aSD);
+        dev = aRng.getGaussian(0, aSD);
         LMR_ = LMR + (LMR * dev);
     } while (dev < -1.0 || dev > 1.0 || LMR_ < 0 || LMR_ > 1);
     LMR = LMR_;
@@ -124,7 +128,7 @@ void Traits::varyTraits(double aSD)
     double m0_, MaxMass_, SeedMass_, Dist_;
     do
     {
-        dev = rng.getGaussian(0, aSD);
+        dev = aRng.getGaussian(0, aSD);
         m0_ = m0 + (m0 * dev);
         MaxMass_ = maxMass + (maxMass * dev);
         SeedMass_ = seedMass + (seedMass * dev);
@@ -139,7 +143,7 @@ void Traits::varyTraits(double aSD)
     int memory_;
     do
     {
-        dev = rng.getGaussian(0, aSD);
+        dev = aRng.getGaussian(0, aSD);
         Gmax_ = Gmax + (Gmax * dev);
         memory_ = memory - (memory * dev);
     } while (dev < -1.0 || dev > 1.0 || Gmax_ < 0 || memory_ < 1);
@@ -149,7 +153,7 @@ void Traits::varyTraits(double aSD)
     double palat_, SLA_;
     do
     {
-        dev = rng.getGaussian(0, aSD);
+        dev = aRng.getGaussian(0, aSD);
         palat_ = palat + (palat * dev);
         SLA_ = SLA + (SLA * dev);
     } while (dev < -1.0 || dev > 1.0 || palat_ < 0 || SLA_ < 0);
@@ -159,7 +163,7 @@ void Traits::varyTraits(double aSD)
     double meanSpacerlength_, sdSpacerlength_;
     do
     {
-        dev = rng.getGaussian(0, aSD);
+        dev = aRng.getGaussian(0, aSD);
         meanSpacerlength_ = meanSpacerlength + (meanSpacerlength * dev);
         sdSpacerlength_ = sdSpacerlength + (sdSpacerlength * dev);
     } while (dev < -1.0 || dev > 1.0 || meanSpacerlength_ < 0 || sdSpacerlength_ < 0);
@@ -167,3 +171,47 @@ void Traits::varyTraits(double aSD)
     sdSpacerlength = sdSpacerlength_;
 
 }
+
+//-----------------------------------------------------------------------------
+
+void Traits::SaveState(CheckpointWriter & aWriter) const
+{
+    aWriter.Write(int32_t(myTraitType));
+    aWriter.Write(PFT_ID);
+    aWriter.Write(PFT_nr);
+
+    for (double v : { LMR, SLA, RAR, m0, maxMass, allocSeed, seedMass, dispersalDist, pEstab,
+                      Gmax, palat, memory, mThres, growth, meanSpacerlength, sdSpacerlength,
+                      allocSpacer, mSpacer })
+    {
+        aWriter.Write(v);
+    }
+
+    for (int v : { dormancy, flowerWeek, dispersalWeek, int(clonal), int(resourceShare) })
+    {
+        aWriter.Write(int32_t(v));
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void Traits::LoadState(CheckpointReader & aReader)
+{
+    myTraitType = traitType(aReader.Read<int32_t>());
+    aReader.Read(PFT_ID);
+    aReader.Read(PFT_nr);
+
+    for (double* v : { &LMR, &SLA, &RAR, &m0, &maxMass, &allocSeed, &seedMass, &dispersalDist, &pEstab,
+                       &Gmax, &palat, &memory, &mThres, &growth, &meanSpacerlength, &sdSpacerlength,
+                       &allocSpacer, &mSpacer })
+    {
+        aReader.Read(*v);
+    }
+
+    for (int* v : { &dormancy, &flowerWeek, &dispersalWeek })
+    {
+        *v = aReader.Read<int32_t>();
+    }
+    clonal = aReader.Read<int32_t>() != 0;
+    resourceShare = aReader.Read<int32_t>() != 0;
+}
@@ -7,6 +7,10 @@
 #include <vector>
 #include <memory>
 
+class RandomGenerator;
+class CheckpointWriter;
+class CheckpointReader;
+
 /**
  * Structure to store all PFT Parameters
  */
@@ -22,11 +26,9 @@ public:
     };
 
 //general
-    std::map< std::string, std::unique_ptr<Traits> > pftTraitTemplates; // links of PFTs (Traits) used
-    std::vector< std::string > pftInsertionOrder;
-
     traitType myTraitType; 	// The default trait set is a species -- only after being varied is it individualized.
     std::string PFT_ID;    	// name of functional type
+    int PFT_nr;             // position of the PFT in the (alphabetical) list of PFTs
 
 //morphology
     double LMR;     // leaf mass ratio (LMR) (leaf mass per shoot mass) [0;1] 1 -> only leafs, 0 -> only stem
@@ -77,11 +79,28 @@ public:
     Traits();
     Traits(const Traits& s);
 
-    void varyTraits(double);
-    void ReadPFTDef(const std::string& file);
-    std::unique_ptr<Traits> createTraitSetFromPftType(std::string type);
-    std::unique_ptr<Traits> copyTraitSet(const std::unique_ptr<Traits> & t);
+    void varyTraits(double, RandomGenerator&);
 
+    void SaveState(CheckpointWriter & aWriter) const;   // an individualized trait set of a checkpoint
+    void LoadState(CheckpointReader & aReader);
+
+};
+
+/**
+ * The trait sets of all PFTs of a run. They are shared (flyweight) by every seed and plant
+ * of the PFT; only with intraspecific trait variation a seed gets an individual copy.
+ */
+class TraitTable
+{
+
+public:
+    std::map< std::string, std::shared_ptr<const Traits> > pftTraitTemplates; // links of PFTs (Traits) used
+    std::vector< std::string > pftInsertionOrder;
+    std::vector< std::shared_ptr<const Traits> > pftByNr;                    // the same trait sets, indexed by Traits::PFT_nr
+
+    void ReadPFTDef(const std::string& file);
+    const std::shared_ptr<const Traits> & getTraitSet(const std::string& type) const;
+    inline const std::shared_ptr<const Traits> & getTraitSet(int nr) const { return pftByNr[nr]; }
 };
 
 #endif /* SPFTTRAITS_H_ */
@@ -0,0 +1,132 @@
+#include <cassert>
+
+#include "WeightedSampler.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+WeightedSampler::WeightedSampler() : NPositive(0), TopBit(0)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Negative weights are taken as 0.
+ */
+void WeightedSampler::Build(const vector<double> & aWeights)
+{
+    Weight.resize(aWeights.size());
+
+    NPositive = 0;
+    for (int i = 0; i < size(); i++)
+    {
+        Weight[i] = (aWeights[i] > 0) ? aWeights[i] : 0;
+        if (Weight[i] > 0)
+        {
+            NPositive++;
+        }
+    }
+
+    TopBit = 1;
+    while (TopBit * 2 <= size())
+    {
+        TopBit *= 2;
+    }
+
+    rebuild();
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * The tree in O(n): every node passes its sum on to its parent.
+ */
+void WeightedSampler::rebuild()
+{
+    const int n = size();
+
+    Tree.assign(n + 1, 0);
+    for (int k = 1; k <= n; k++)
+    {
+        Tree[k] += Weight[k - 1];
+
+        int parent = k + (k & -k);
+        if (parent <= n)
+        {
+            Tree[parent] += Tree[k];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void WeightedSampler::Set(int aIndex, double aWeight)
+{
+    if (aWeight < 0)
+    {
+        aWeight = 0;
+    }
+
+    NPositive += (aWeight > 0) - (Weight[aIndex] > 0);
+
+    const double delta = aWeight - Weight[aIndex];
+    Weight[aIndex] = aWeight;
+
+    for (int k = aIndex + 1; k <= size(); k += k & -k)
+    {
+        Tree[k] += delta;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+double WeightedSampler::Total() const
+{
+    double sum = 0;
+    for (int k = size(); k > 0; k -= k & -k)
+    {
+        sum += Tree[k];
+    }
+    return sum;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Descends the tree to the first index whose cumulative weight exceeds aUniform * Total().
+ */
+int WeightedSampler::Draw(double aUniform)
+{
+    assert(!Empty());
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        double target = aUniform * Total();
+
+        int k = 0;
+        for (int bit = TopBit; bit > 0; bit /= 2)
+        {
+            if (k + bit <= size() && Tree[k + bit] <= target)
+            {
+                k += bit;
+                target -= Tree[k];
+            }
+        }
+
+        if (k < size() && Weight[k] > 0)
+        {
+            return k;
+        }
+
+        // the partial sums have drifted
+        rebuild();
+    }
+
+    // the last positive weight, if even the rebuilt sums do not resolve the draw
+    int last = size() - 1;
+    while (Weight[last] <= 0)
+    {
+        last--;
+    }
+    return last;
+}
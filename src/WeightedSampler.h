@@ -0,0 +1,38 @@
+#ifndef SRC_WEIGHTEDSAMPLER_H_
+#define SRC_WEIGHTEDSAMPLER_H_
+
+#include <vector>
+
+//! Draws indices with probability proportional to weights that change between the draws
+/*! The weights are kept in a Fenwick (binary indexed) tree, so that changing one weight and
+ drawing one index both take O(log n). Used by the aboveground grazing, where every bite
+ changes the palatability of the plant it was taken from.
+ The partial sums of the tree are updated by differences and may drift by rounding; the
+ exact weights are kept beside them, and the tree is rebuilt if a draw hits a zero weight.
+ */
+class WeightedSampler
+{
+
+private:
+    std::vector<double> Weight;     // by index
+    std::vector<double> Tree;       // Tree[k]: sum of the weights (k - lowbit(k), k], 1-based
+    int NPositive;                  // number of weights > 0
+    int TopBit;                     // highest power of two <= size
+
+    void rebuild();
+
+public:
+    WeightedSampler();
+
+    void Build(const std::vector<double> & aWeights);
+    void Set(int aIndex, double aWeight);
+
+    inline int size() const { return int(Weight.size()); }
+    inline bool Empty() const { return NPositive == 0; }   // no index can be drawn
+    inline double Get(int aIndex) const { return Weight[aIndex]; }
+    double Total() const;
+
+    int Draw(double aUniform);      // index for a uniform number in [0, 1), requires !Empty()
+};
+
+#endif
@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+#include "itv_mode.h"
+#include "Cell.h"
+#include "Plant.h"
+#include "Traits.h"
+#include "PlantStore.h"
+#include "ZOICoverage.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+ZOICoverage::ZOICoverage() : GridSize(0)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Precomputes the stencil from the cell indices sorted by their distance to the
+ * center of the grid (Grid::ZOIBase).
+ */
+void ZOICoverage::Init(long aGridSize, const vector<int> & aZOIBase, int aNPfts)
+{
+    GridSize = aGridSize;
+
+    StencilX.resize(aZOIBase.size());
+    StencilY.resize(aZOIBase.size());
+
+    for (unsigned int a = 0; a < aZOIBase.size(); a++)
+    {
+        StencilX[a] = aZOIBase[a] / GridSize - GridSize / 2;
+        StencilY[a] = aZOIBase[a] % GridSize - GridSize / 2;
+    }
+
+    AboveStart.assign(GridSize * GridSize + 1, 0);
+    BelowStart.assign(GridSize * GridSize + 1, 0);
+
+    PftCount.assign(aNPfts, 0);
+    PftSeen.reserve(aNPfts);
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Adds the cells of the stencil up to the given area to the cached cells of a plant.
+ */
+void ZOICoverage::extendCoveredCells(Plant* aPlant, int aArea)
+{
+    vector<int> & cells = aPlant->coveredCells;
+
+    int px = aPlant->getCell()->x;
+    int py = aPlant->getCell()->y;
+
+    for (int a = int(cells.size()); a < aArea; a++)
+    {
+        int x = px + StencilX[a];
+        int y = py + StencilY[a];
+
+        // the stencil reaches at most half a grid width, one wrap is enough
+        if (x < 0) x += GridSize; else if (x >= GridSize) x -= GridSize;
+        if (y < 0) y += GridSize; else if (y >= GridSize) y -= GridSize;
+
+        cells.push_back(x * GridSize + y);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Calculates the ZOI of all plants and sorts the covered cells into the flat arrays.
+ * Dead plants still shade others, but do not compete for belowground resources.
+ */
+void ZOICoverage::Build(const vector< shared_ptr<Plant> > & aPlants)
+{
+    const int nCells = GridSize * GridSize;
+    const int maxArea = int(StencilX.size());
+
+    fill(AboveStart.begin(), AboveStart.end(), 0);
+    fill(BelowStart.begin(), BelowStart.end(), 0);
+
+    // 1. area of each plant, count the entries of each cell
+    for (auto const& plant : aPlants)
+    {
+        double Ashoot = plant->Area_shoot();
+        plant->Ash_disc() = floor(Ashoot) + 1;
+
+        double Aroot = plant->Area_root();
+        plant->Art_disc() = floor(Aroot) + 1;
+
+        plant->nCoveredA = min(maxArea, int(ceil(max(0.0, Ashoot))));
+        plant->nCoveredB = plant->isDead() ? 0 : min(maxArea, int(ceil(max(0.0, Aroot))));
+
+        int n = max(plant->nCoveredA, plant->nCoveredB);
+        if (int(plant->coveredCells.size()) < n)
+        {
+            extendCoveredCells(plant.get(), n);
+        }
+
+        const int* cells = plant->coveredCells.data();
+        for (int a = 0; a < plant->nCoveredA; a++)
+        {
+            AboveStart[cells[a] + 1]++;
+        }
+        for (int a = 0; a < plant->nCoveredB; a++)
+        {
+            BelowStart[cells[a] + 1]++;
+        }
+    }
+
+    // 2. prefix sums are the first entry of each cell
+    for (int c = 0; c < nCells; c++)
+    {
+        AboveStart[c + 1] += AboveStart[c];
+        BelowStart[c + 1] += BelowStart[c];
+    }
+
+    // 3. place the plants into their cells, in the order of the PlantList
+    AboveIdx.resize(AboveStart[nCells]);
+    BelowIdx.resize(BelowStart[nCells]);
+
+    sortEntries(AboveStart, AboveIdx, aPlants, true);
+    sortEntries(BelowStart, BelowIdx, aPlants, false);
+}
+
+//-----------------------------------------------------------------------------
+
+void ZOICoverage::sortEntries(const vector<int> & aStart, vector<int> & aIdx,
+                              const vector< shared_ptr<Plant> > & aPlants, bool aAbove)
+{
+    Fill.assign(aStart.begin(), aStart.end() - 1);
+
+    for (int i = 0; i < int(aPlants.size()); i++)
+    {
+        const Plant* plant = aPlants[i].get();
+        const int* cells = plant->coveredCells.data();
+        const int n = aAbove ? plant->nCoveredA : plant->nCoveredB;
+
+        for (int a = 0; a < n; a++)
+        {
+            aIdx[Fill[cells[a]]++] = i;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Competition coefficient of the plant in slot i (Plant::comp_coef()):
+ * sym: maximal resource utilization, asympart: proportional to the mass of the layer,
+ * asymtot: the size that decides the winner (shoot geometry above, root mass below ground)
+ */
+template <CompMode Mode, bool Above>
+static inline double compCoef(const PlantStore & aPlants, int i)
+{
+    if (Mode == sym)
+        return aPlants.Gmax[i];
+
+    if (Mode == asymtot)
+        return Above ? aPlants.mShoot[i] / aPlants.LMR[i] : aPlants.mRoot[i];
+
+    return Above ? aPlants.mShoot[i] * aPlants.CompPowerA[i] : aPlants.mRoot[i] * aPlants.Gmax[i];
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Fills the coefficient (and PFT) of every entry, so that competition runs over flat
+ * arrays in the order of the entries.
+ */
+template <CompMode Mode, bool Above>
+void ZOICoverage::gatherEntries(const vector<int> & aIdx, const PlantStore & aPlants, bool aWithPft)
+{
+    PlantCoef.resize(aPlants.size());
+    for (int i = 0; i < aPlants.size(); i++)
+    {
+        PlantCoef[i] = compCoef<Mode, Above>(aPlants, i);
+    }
+
+    EntryCoef.resize(aIdx.size());
+    for (unsigned int k = 0; k < aIdx.size(); k++)
+    {
+        EntryCoef[k] = PlantCoef[aIdx[k]];
+    }
+
+    if (aWithPft)
+    {
+        EntryPft.resize(aIdx.size());
+        for (unsigned int k = 0; k < aIdx.size(); k++)
+        {
+            EntryPft[k] = aPlants.pft[aIdx[k]];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Distributes the resources of every cell among the plants covering it, and
+ * records the total competitive strength of each cell.
+ */
+void ZOICoverage::DistributeResource(Cell** aCells, PlantStore & aPlants,
+                                     CompMode aAboveMode, CompMode aBelowMode, stabilizationMode aStabilization)
+{
+    distributeLayer<true>(AboveStart, AboveIdx, aCells, aPlants, aAboveMode, aStabilization);
+    distributeLayer<false>(BelowStart, BelowIdx, aCells, aPlants, aBelowMode, aStabilization);
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Selects the kernels of the layer once per week; everything below runs without
+ * runtime switches.
+ */
+template <bool Above>
+void ZOICoverage::distributeLayer(const vector<int> & aStart, const vector<int> & aIdx, Cell** aCells,
+                                  PlantStore & aPlants, CompMode aMode, stabilizationMode aStabilization)
+{
+    const bool withPft = aStabilization != version1;
+
+    vector<double> & uptake = Above ? aPlants.Auptake : aPlants.Buptake;
+
+    switch (aMode)
+    {
+    case sym:
+        gatherEntries<sym, Above>(aIdx, aPlants, withPft);
+        break;
+    case asympart:
+        gatherEntries<asympart, Above>(aIdx, aPlants, withPft);
+        break;
+    case asymtot:
+        // the stabilization does not change who is the largest
+        gatherEntries<asymtot, Above>(aIdx, aPlants, false);
+        competeWinner<Above>(aStart, aIdx, aCells, uptake);
+        return;
+    default:
+        cerr << "ZOICoverage::DistributeResource() - competition mode not supported\n";
+        exit(1);
+    }
+
+    switch (aStabilization)
+    {
+    case version1:
+        compete<version1, Above>(aStart, aIdx, aCells, uptake);
+        break;
+    case version2:
+        compete<version2, Above>(aStart, aIdx, aCells, uptake);
+        break;
+    case version3:
+        compete<version3, Above>(aStart, aIdx, aCells, uptake);
+        break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * version1: no difference between intra- and interspecific competition
+ * version2: competitive strength is divided by the square root of the number of
+ *           plants of the same PFT in the cell
+ * version3: competitive strength is reduced by the number of PFTs in the cell
+ */
+template <stabilizationMode Stabilization, bool Above>
+void ZOICoverage::compete(const vector<int> & aStart, const vector<int> & aIdx, Cell** aCells,
+                          vector<double> & aUptake)
+{
+    const int nCells = GridSize * GridSize;
+
+    const double* coef = EntryCoef.data();
+    const int* pfts = EntryPft.data();
+    const int* idx = aIdx.data();
+
+    for (int c = 0; c < nCells; c++)
+    {
+        const int begin = aStart[c];
+        const int end = aStart[c + 1];
+
+        if (begin == end)
+            continue;
+
+        Cell* cell = aCells[c];
+
+        double propDistinct = 1;
+        if (Stabilization != version1)
+        {
+            for (int k = begin; k < end; k++)
+            {
+                if (PftCount[pfts[k]]++ == 0)
+                {
+                    PftSeen.push_back(pfts[k]);
+                }
+            }
+            propDistinct = PftSeen.size() / (1.0 + PftSeen.size());
+        }
+
+        auto strength = [&] (int k)
+        {
+            if (Stabilization == version2)
+                return coef[k] * (1.0 / std::sqrt(PftCount[pfts[k]]));
+            if (Stabilization == version3)
+                return coef[k] * propDistinct;
+            return coef[k];
+        };
+
+        //1. sum of resource requirement
+        double comp_tot = 0;
+        for (int k = begin; k < end; k++)
+        {
+            comp_tot += strength(k);
+        }
+
+        //2. distribute resources
+        const double res = Above ? cell->AResConc : cell->BResConc;
+        for (int k = begin; k < end; k++)
+        {
+            aUptake[idx[k]] += res * strength(k) / comp_tot;
+        }
+
+        if (Above)
+            cell->aComp_weekly = comp_tot;
+        else
+            cell->bComp_weekly = comp_tot;
+
+        if (Stabilization != version1)
+        {
+            for (int pft : PftSeen)
+            {
+                PftCount[pft] = 0;
+            }
+            PftSeen.clear();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Total asymmetry: the largest plant of each cell takes all of its resource
+ * (the first one in the order of the PlantList, if several are equally large).
+ */
+template <bool Above>
+void ZOICoverage::competeWinner(const vector<int> & aStart, const vector<int> & aIdx, Cell** aCells,
+                                vector<double> & aUptake)
+{
+    const int nCells = GridSize * GridSize;
+
+    const double* coef = EntryCoef.data();
+    const int* idx = aIdx.data();
+
+    for (int c = 0; c < nCells; c++)
+    {
+        const int begin = aStart[c];
+        const int end = aStart[c + 1];
+
+        if (begin == end)
+            continue;
+
+        int winner = begin;
+        for (int k = begin + 1; k < end; k++)
+        {
+            if (coef[k] > coef[winner])
+            {
+                winner = k;
+            }
+        }
+
+        aUptake[idx[winner]] += Above ? aCells[c]->AResConc : aCells[c]->BResConc;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef SRC_ZOICOVERAGE_H_
+#define SRC_ZOICOVERAGE_H_
+
+#include <vector>
+#include <memory>
+
+#include "Parameters.h"
+
+class Cell;
+class Plant;
+class PlantStore;
+
+//! Flat coverage of the grid by the zones of influence (ZOI) of all plants
+/*! Instead of a list of plants per cell, the plants covering a cell are stored in one
+ array per layer, ordered by cell (compressed sparse rows). Start[c] .. Start[c+1] are the
+ entries of cell c; each entry is the index of the plant in the PlantList and its PlantStore.
+ The arrays are rebuilt every week by a counting sort over all plants, which keeps
+ the order of the plants within a cell the same as in the PlantList.
+
+ A ZOI of area a covers the a cells of the stencil that are closest to the plant. The
+ stencil is sorted by distance, so the disc of every integer area is a prefix of it.
+ Every plant keeps the grid cells of the largest disc it ever had (Plant::coveredCells);
+ they are only extended when the plant grows beyond it, because plants do not move.
+
+ Competition runs over a flat buffer of entry coefficients with kernels that are
+ specialized at compile time on the competition mode and the stabilization version.
+ */
+class ZOICoverage
+{
+
+private:
+    long GridSize;
+    std::vector<int> StencilX;          // offset of the stencil cells, nearest first
+    std::vector<int> StencilY;
+
+    std::vector<int> Fill;              // scratch: next free entry of each cell
+    std::vector<int> PftCount;          // scratch: plants per PFT in the current cell
+    std::vector<int> PftSeen;           // scratch: PFTs touched in the current cell
+    std::vector<double> PlantCoef;      // scratch: competition coefficient of every plant
+    std::vector<double> EntryCoef;      // competition coefficient of every entry of the current layer
+    std::vector<int> EntryPft;          // PFT of every entry of the current layer (stabilization only)
+
+    void extendCoveredCells(Plant* aPlant, int aArea);
+    void sortEntries(const std::vector<int> & aStart, std::vector<int> & aIdx,
+                     const std::vector< std::shared_ptr<Plant> > & aPlants, bool aAbove);
+
+    // competition kernels, specialized on the competition mode and the stabilization version
+    template <bool Above>
+    void distributeLayer(const std::vector<int> & aStart, const std::vector<int> & aIdx, Cell** aCells,
+                         PlantStore & aPlants, CompMode aMode, stabilizationMode aStabilization);
+    template <CompMode Mode, bool Above>
+    void gatherEntries(const std::vector<int> & aIdx, const PlantStore & aPlants, bool aWithPft);
+    template <stabilizationMode Stabilization, bool Above>
+    void compete(const std::vector<int> & aStart, const std::vector<int> & aIdx, Cell** aCells,
+                 std::vector<double> & aUptake);
+    template <bool Above>
+    void competeWinner(const std::vector<int> & aStart, const std::vector<int> & aIdx, Cell** aCells,
+                       std::vector<double> & aUptake);
+
+public:
+    std::vector<int> AboveStart;        // size: number of cells + 1
+    std::vector<int> AboveIdx;          // plant index of every aboveground entry
+    std::vector<int> BelowStart;
+    std::vector<int> BelowIdx;
+
+    ZOICoverage();
+
+    void Init(long aGridSize, const std::vector<int> & aZOIBase, int aNPfts);
+    void Build(const std::vector< std::shared_ptr<Plant> > & aPlants);
+    void DistributeResource(Cell** aCells, PlantStore & aPlants,
+                            CompMode aAboveMode, CompMode aBelowMode, stabilizationMode aStabilization);
+
+    inline int NAbove(int aCell) const { return AboveStart[aCell + 1] - AboveStart[aCell]; }
+    inline int NBelow(int aCell) const { return BelowStart[aCell + 1] - BelowStart[aCell]; }
+    inline int NEntries() const { return int(AboveIdx.size() + BelowIdx.size()); }
+};
+
+#endif
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Runs the canonical benchmark scenarios of IBC-grass with fixed seeds and reports
+weeks per second, peak memory and the time of the weekly phases (--profile).
+
+    python3 bench.py [options] <ibcgrass binary>
+
+    --only name[,name]   run only these scenarios
+    --save file          write the results as CSV
+    --baseline file      compare with a saved CSV; exits with 1 if a scenario got slower
+    --tolerance x        allowed slowdown against the baseline (default 0.15)
+    --seed n             seed of the runs (default 1)
+    --extra "args"       further arguments for every run, e.g. "--rng=xoshiro256"
+
+Usually started by `make bench` (BENCH_ARGS passes the options).
+"""
+
+import sys, os, csv, argparse, shutil, subprocess, tempfile, time
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+
+# name, SimFile in data/in, extra arguments of the binary
+SCENARIOS = [
+    ("monoculture", "monoculture.txt", []),
+    ("community",   "community.txt",   []),
+    ("itv",         "itv.txt",         []),
+    ("grazing",     "grazing.txt",     []),
+    ("clonal",      "clonal.txt",      []),
+    ("largegrid",   "largegrid.txt",   ["--gridsize=346"]),
+]
+
+PHASES = ["ResetWeeklyVariables", "SetCellResources", "CoverCells", "DistributeResource",
+          "PlantLoop", "Disturb", "RemovePlants", "EstablishmentLottery", "Seasonal", "Output"]
+
+
+def run_scenario(binary, name, simfile, extra, seed):
+    """ Runs one scenario in a scratch directory, returns its measurements. """
+    work = tempfile.mkdtemp(prefix="ibc-bench-")
+    try:
+        os.makedirs(os.path.join(work, "data", "out"))
+        os.symlink(os.path.join(BENCH_DIR, "data", "in"), os.path.join(work, "data", "in"))
+
+        cmd = [binary, "-s", str(seed), "--profile=run"] + extra + [os.path.join("data", "in", simfile), name]
+
+        start = time.perf_counter()
+        proc = subprocess.Popen(cmd, cwd=work, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        _, status, usage = os.wait4(proc.pid, 0)
+        wall = time.perf_counter() - start
+
+        if status != 0:
+            raise RuntimeError("scenario %s failed with status %d" % (name, status))
+
+        with open(os.path.join(work, "data", "out", name + "_profile.csv")) as f:
+            rows = [{k.strip(): v.strip() for k, v in row.items()} for row in csv.DictReader(f, skipinitialspace=True)]
+        total = [row for row in rows if row["Year"] == "total"][-1]
+
+        result = {
+            "scenario": name,
+            "wall_s": wall,
+            "weeks": int(total["Weeks"]),
+            "weeks_per_s": int(total["Weeks"]) / wall,
+            "peak_rss_mb": usage.ru_maxrss / 1024.0,   # kilobytes on Linux
+            "plants": float(total["Plants"]),
+        }
+        for phase in PHASES:
+            result[phase] = float(total[phase])
+
+        return result
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+
+
+def print_results(results):
+    print("%-12s %8s %9s %9s %9s" % ("scenario", "wall[s]", "weeks/s", "RSS[MB]", "plants"))
+    for r in results:
+        print("%-12s %8.2f %9.1f %9.1f %9.0f" % (r["scenario"], r["wall_s"], r["weeks_per_s"], r["peak_rss_mb"], r["plants"]))
+
+    print()
+    print("%-12s " % "seconds" + " ".join("%8.8s" % p for p in PHASES))
+    for r in results:
+        print("%-12s " % r["scenario"] + " ".join("%8.3f" % r[p] for p in PHASES))
+
+
+def compare(results, baseline_file, tolerance):
+    """ Reports the scenarios whose throughput dropped by more than the tolerance. """
+    with open(baseline_file) as f:
+        baseline = {row["scenario"]: row for row in csv.DictReader(f)}
+
+    slower = []
+    print()
+    for r in results:
+        if r["scenario"] not in baseline:
+            continue
+        before = float(baseline[r["scenario"]]["weeks_per_s"])
+        change = r["weeks_per_s"] / before - 1
+        print("%-12s %+7.1f%% weeks/s" % (r["scenario"], 100 * change))
+        if change < -tolerance:
+            slower.append(r["scenario"])
+
+    if slower:
+        print("slower than the baseline: " + ", ".join(slower))
+    return not slower
+
+
+def main():
+    parser = argparse.ArgumentParser(description="IBC-grass benchmark scenarios")
+    parser.add_argument("binary")
+    parser.add_argument("--only", default="")
+    parser.add_argument("--save", default="")
+    parser.add_argument("--baseline", default="")
+    parser.add_argument("--tolerance", type=float, default=0.15)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--extra", default="")
+    args = parser.parse_args()
+
+    binary = os.path.abspath(args.binary)
+    only = [s for s in args.only.split(",") if s]
+
+    results = []
+    for name, simfile, extra in SCENARIOS:
+        if only and name not in only:
+            continue
+        results.append(run_scenario(binary, name, simfile, extra + args.extra.split(), args.seed))
+
+    print_results(results)
+
+    if args.save:
+        with open(args.save, "w") as f:
+            writer = csv.DictWriter(f, fieldnames=list(results[0].keys()))
+            writer.writeheader()
+            writer.writerows(results)
+
+    if args.baseline and not compare(results, args.baseline, args.tolerance):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
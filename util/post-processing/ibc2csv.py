@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""
+Reads the binary tables of IBC-grass (--output=binary, <prefix>_srv.bin, _PFT.bin,
+_ind.bin and _aggregated.bin) and converts them to the CSV tables the text output has.
+
+    python3 ibc2csv.py <table.bin> [<table.csv>]
+
+Tables written with --compress (<table.bin.gz>) are read as well. Without an output
+name the CSV goes next to the binary file. The file is read one chunk at a time, a
+chunk holds at most a block of rows of one run. The binary tables keep the numbers
+as the text prints them, so the CSV is the one the text output would have written.
+
+As a module, read_chunks(filename) yields the column names and types, then the columns
+of every chunk; read_table(filename) collects the columns of all runs.
+"""
+
+import sys, os, math, gzip
+
+MAGIC = b"IBCTAB2\n"
+
+# exponents of the reals without digits (mantissa 0)
+ZERO, MISSING, NEGATIVE_ZERO, INFINITY, NEGATIVE_INFINITY, NAN, NEGATIVE_NAN = range(7)
+SPECIALS = {
+    ZERO: 0.0, MISSING: None, NEGATIVE_ZERO: -0.0,
+    INFINITY: math.inf, NEGATIVE_INFINITY: -math.inf, NAN: math.nan, NEGATIVE_NAN: -math.nan,
+}
+INT_NA = -2**31
+
+
+def read_varint(f):
+    """ A varint from the file, None at its end. """
+    value, shift = 0, 0
+    while True:
+        b = f.read(1)
+        if not b:
+            if shift > 0:
+                raise ValueError("the table ends within a number")
+            return None
+        value |= (b[0] & 0x7f) << shift
+        shift += 7
+        if b[0] < 0x80:
+            return value
+
+
+class Chunk:
+    """ Sequential reads from the bytes of one chunk. """
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def bytes(self, n):
+        if self.pos + n > len(self.data):
+            raise ValueError("the chunk is shorter than its columns")
+        b = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return b
+
+    def varint(self):
+        data, pos = self.data, self.pos
+        value, shift = 0, 0
+        while True:
+            b = data[pos]
+            pos += 1
+            value |= (b & 0x7f) << shift
+            shift += 7
+            if b < 0x80:
+                self.pos = pos
+                return value
+
+    def signed(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def text(self):
+        return self.bytes(self.varint()).decode("utf-8")
+
+    def column(self, nrows):
+        """ The integers of a column in one of the encodings p, v, r and d. """
+        encoding = self.bytes(1)
+        if encoding == b"p":
+            return [self.signed() for _ in range(nrows)]
+        if encoding == b"v":
+            values, value = [], 0
+            for _ in range(nrows):
+                value += self.signed()
+                values.append(value)
+            return values
+        if encoding == b"r":
+            values = []
+            for _ in range(self.varint()):
+                value = self.signed()
+                values.extend([value] * self.varint())
+            return values
+        if encoding == b"d":
+            distinct = [self.signed() for _ in range(self.varint())]
+            bits = self.bytes(1)[0]
+            if bits == 0:
+                return distinct * nrows
+            return [distinct[i] for i in unpack(self.bytes((nrows * bits + 7) // 8), bits, nrows)]
+        raise ValueError("unknown encoding of a column: %r" % encoding)
+
+
+def unpack(packed, bits, n):
+    """ The n indices of as many bits, packed from the lowest bit of the first byte on. """
+    mask = (1 << bits) - 1
+    indices = []
+    buffer, filled = 0, 0
+    for byte in packed:
+        buffer |= byte << filled
+        filled += 8
+        while filled >= bits:
+            indices.append(buffer & mask)
+            buffer >>= bits
+            filled -= bits
+    return indices[:n]
+
+
+def real(mantissa, exponent):
+    """ The value the text printed; more than 6 digits are an int the text printed as such. """
+    if mantissa == 0:
+        return SPECIALS[exponent]
+    if abs(mantissa) > 999999:
+        return mantissa
+    if exponent < 0:
+        return mantissa / 10**-exponent
+    return float(mantissa * 10**exponent)
+
+
+def read_chunks(filename):
+    """ Yields the column names and types, then one list of columns per chunk. """
+    opener = gzip.open if filename.endswith(".gz") else open
+    with opener(filename, "rb") as f:
+        if f.read(len(MAGIC)) != MAGIC:
+            raise ValueError(filename + " is no IBC-grass table of this version")
+
+        columns = []
+        for _ in range(read_varint(f)):
+            kind = f.read(1).decode()
+            columns.append((f.read(read_varint(f)).decode("utf-8"), kind))
+        yield columns
+
+        while True:
+            size = read_varint(f)
+            if size is None:
+                return
+            data = f.read(size)
+            if len(data) != size:
+                raise ValueError("the table ends within a chunk")
+
+            r = Chunk(data)
+            nrows = r.varint()
+            dictionary = [r.text() for _ in range(r.varint())]
+
+            chunk = []
+            for name, kind in columns:
+                if kind == "t":
+                    values = [dictionary[code] for code in r.column(nrows)]
+                elif kind == "i":
+                    values = [None if v == INT_NA else v for v in r.column(nrows)]
+                else:
+                    exponents = r.column(nrows)
+                    values = [real(m, e) for m, e in zip(r.column(nrows), exponents)]
+                chunk.append(values)
+            yield chunk
+
+
+def read_table(filename):
+    """ Column names and the columns of all runs of a table; missing values are None. """
+    chunks = read_chunks(filename)
+    names = [name for name, kind in next(chunks)]
+
+    table = [[] for _ in names]
+    for chunk in chunks:
+        for column, values in zip(table, chunk):
+            column.extend(values)
+
+    return names, table
+
+
+def format_value(value, kind):
+    """ As std::ostream formats it: %g with 6 digits for doubles. """
+    if value is None:
+        return "NA"
+    if kind == "r" and isinstance(value, float):
+        if math.isnan(value):
+            return "-nan" if math.copysign(1, value) < 0 else "nan"
+        return "%g" % value
+    return str(value)
+
+
+def to_csv(filename, csvname):
+    chunks = read_chunks(filename)
+    columns = next(chunks)
+    kinds = [kind for name, kind in columns]
+
+    with open(csvname, "w", newline="") as out:
+        out.write(", ".join(name for name, kind in columns) + "\n")
+
+        for chunk in chunks:
+            formatted = [[format_value(v, kind) for v in values] for values, kind in zip(chunk, kinds)]
+            out.writelines(", ".join(row) + "\n" for row in zip(*formatted))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) not in (2, 3):
+        sys.exit(__doc__)
+
+    source = sys.argv[1]
+    stem = source[:-len(".gz")] if source.endswith(".gz") else source
+    target = sys.argv[2] if len(sys.argv) == 3 else os.path.splitext(stem)[0] + ".csv"
+
+    to_csv(source, target)